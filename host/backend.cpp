@@ -0,0 +1,330 @@
+//   Stand-in backends for the Linux host build
+//
+//   nmount/unmount keep a mount table in $(GM_ROOT)/proc/self/mountinfo, in
+//   the kernel's mountinfo format, so the mount state survives between runs
+//   and several host processes see the same table. Nothing is really
+//   mounted: a nullfs "mount" only records its source and target.
+//   Registration only checks the title directory; notifications are
+//   recorded to $(GM_ROOT)/notifications.log.
+//
+//   Each call can be slowed down to model the console, in microseconds:
+//   GM_HOST_MOUNT_US, GM_HOST_UNMOUNT_US, GM_HOST_REGISTER_US and
+//   GM_HOST_NOTIFY_US (default 0).
+#include "host.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MOUNTINFO_FILE GM_ROOT "/proc/self/mountinfo"
+#define MAX_MOUNTS     16384
+
+typedef struct {
+    char fstype[MFSNAMELEN];
+    char from[PATH_MAX];
+    char on[PATH_MAX];
+} host_mount_t;
+
+typedef struct {
+    host_mount_t* items;
+    int count;
+    int capacity;
+} host_table_t;
+
+static pthread_mutex_t table_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// ---------------- LATENCY ----------------
+enum { LAT_MOUNT, LAT_UNMOUNT, LAT_REGISTER, LAT_NOTIFY, LAT_COUNT };
+
+static const char* LATENCY_VARS[LAT_COUNT] = {
+    "GM_HOST_MOUNT_US", "GM_HOST_UNMOUNT_US", "GM_HOST_REGISTER_US", "GM_HOST_NOTIFY_US",
+};
+
+static unsigned int latency_us[LAT_COUNT];
+static pthread_once_t latency_once = PTHREAD_ONCE_INIT;
+
+static void latency_init(void) {
+    for (int i = 0; i < LAT_COUNT; i++) {
+        const char* v = getenv(LATENCY_VARS[i]);
+        latency_us[i] = v ? (unsigned int)strtoul(v, NULL, 10) : 0;
+    }
+}
+
+static void simulate_latency(int call) {
+    pthread_once(&latency_once, latency_init);
+    if (latency_us[call] > 0)
+        usleep(latency_us[call]);
+}
+
+// mountinfo escapes blanks and backslashes as \ooo
+static void escape_field(FILE* f, const char* s) {
+    for (; *s; s++) {
+        if (*s == ' ' || *s == '\t' || *s == '\n' || *s == '\\')
+            fprintf(f, "\\%03o", (unsigned char)*s);
+        else
+            fputc(*s, f);
+    }
+}
+
+static void unescape_field(char* s) {
+    char* out = s;
+    for (char* p = s; *p; p++) {
+        if (p[0] == '\\' && p[1] >= '0' && p[1] <= '7' && p[2] && p[3]) {
+            *out++ = (char)(((p[1] - '0') << 6) | ((p[2] - '0') << 3) | (p[3] - '0'));
+            p += 3;
+        } else {
+            *out++ = *p;
+        }
+    }
+    *out = '\0';
+}
+
+// Opens the table with an exclusive lock; the caller closes the fd
+static int table_open(void) {
+    mkdir(GM_ROOT "/proc", 0755);
+    mkdir(GM_ROOT "/proc/self", 0755);
+
+    int fd = open(MOUNTINFO_FILE, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return -1;
+    if (flock(fd, LOCK_EX) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static host_mount_t* table_add(host_table_t* t) {
+    if (t->count >= MAX_MOUNTS) {
+        errno = ENOSPC;
+        return NULL;
+    }
+    if (t->count == t->capacity) {
+        int cap = t->capacity ? t->capacity * 2 : 64;
+        host_mount_t* items = (host_mount_t*)realloc(t->items, cap * sizeof(host_mount_t));
+        if (!items) return NULL;
+        t->items = items;
+        t->capacity = cap;
+    }
+    return &t->items[t->count++];
+}
+
+static int table_read(int fd, host_table_t* t) {
+    FILE* f = fdopen(dup(fd), "r");
+    if (!f) return -1;
+
+    // id parent major:minor root mount-point options - fstype source super
+    char line[3 * PATH_MAX];
+    while (fgets(line, sizeof(line), f)) {
+        char on[PATH_MAX], fstype[MFSNAMELEN], from[PATH_MAX];
+        const char* sep = strstr(line, " - ");
+        if (!sep || sscanf(line, "%*s %*s %*s %*s %4095s", on) != 1 ||
+            sscanf(sep + 3, "%15s %4095s", fstype, from) != 2)
+            continue;
+
+        host_mount_t* m = table_add(t);
+        if (!m) break;
+        unescape_field(on);
+        unescape_field(from);
+        snprintf(m->on, sizeof(m->on), "%s", on);
+        snprintf(m->from, sizeof(m->from), "%s", from);
+        snprintf(m->fstype, sizeof(m->fstype), "%s", fstype);
+    }
+    fclose(f);
+    return 0;
+}
+
+static int table_write(int fd, const host_table_t* t) {
+    if (ftruncate(fd, 0) != 0 || lseek(fd, 0, SEEK_SET) != 0)
+        return -1;
+
+    FILE* f = fdopen(dup(fd), "w");
+    if (!f) return -1;
+
+    for (int i = 0; i < t->count; i++) {
+        const host_mount_t* m = &t->items[i];
+        fprintf(f, "%d 1 0:%d / ", 100 + i, 100 + i);
+        escape_field(f, m->on);
+        fprintf(f, " rw,relatime - %s ", m->fstype);
+        escape_field(f, m->from);
+        fprintf(f, " rw\n");
+    }
+    return fclose(f);
+}
+
+static int table_find(const host_table_t* t, const char* on) {
+    for (int i = t->count - 1; i >= 0; i--)
+        if (!strcmp(t->items[i].on, on))
+            return i;
+    return -1;
+}
+
+static const char* iov_get(struct iovec* iov, unsigned int niov, const char* name) {
+    for (unsigned int i = 0; i + 1 < niov; i += 2)
+        if (iov[i].iov_base && !strcmp((const char*)iov[i].iov_base, name))
+            return (const char*)iov[i + 1].iov_base;
+    return NULL;
+}
+
+extern "C" int nmount(struct iovec* iov, unsigned int niov, int flags) {
+    const char* fstype = iov_get(iov, niov, "fstype");
+    const char* from = iov_get(iov, niov, "from");
+    const char* on = iov_get(iov, niov, "fspath");
+
+    if (!fstype || !from || !on) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // Remounting an existing filesystem (e.g. /system_ex read-write) is a no-op
+    if (flags & MNT_UPDATE)
+        return 0;
+
+    simulate_latency(LAT_MOUNT);
+
+    struct stat st;
+    if (stat(on, &st) != 0 || !S_ISDIR(st.st_mode) || stat(from, &st) != 0) {
+        errno = ENOENT;
+        return -1;
+    }
+
+    pthread_mutex_lock(&table_lock);
+    int fd = table_open();
+    host_table_t t = {};
+    int rc = -1;
+
+    if (fd >= 0 && table_read(fd, &t) == 0) {
+        host_mount_t* m = NULL;
+        if (table_find(&t, on) >= 0) {
+            errno = EBUSY;
+        } else if ((m = table_add(&t)) != NULL) {
+            snprintf(m->fstype, sizeof(m->fstype), "%s", fstype);
+            snprintf(m->from, sizeof(m->from), "%s", from);
+            snprintf(m->on, sizeof(m->on), "%s", on);
+            rc = table_write(fd, &t);
+        }
+    }
+
+    free(t.items);
+    if (fd >= 0) close(fd);
+    pthread_mutex_unlock(&table_lock);
+    return rc;
+}
+
+extern "C" int unmount(const char* dir, int flags) {
+    (void)flags;
+    simulate_latency(LAT_UNMOUNT);
+
+    pthread_mutex_lock(&table_lock);
+    int fd = table_open();
+    host_table_t t = {};
+    int rc = -1;
+
+    if (fd >= 0 && table_read(fd, &t) == 0) {
+        int i = table_find(&t, dir);
+        if (i < 0) {
+            errno = EINVAL;
+        } else {
+            t.items[i] = t.items[--t.count];
+            rc = table_write(fd, &t);
+        }
+    }
+
+    free(t.items);
+    if (fd >= 0) close(fd);
+    pthread_mutex_unlock(&table_lock);
+    return rc;
+}
+
+// Reports the innermost recorded mount containing path, else the host fs
+extern "C" int gm_statfs(const char* path, struct gm_statfs* buf) {
+    struct stat st;
+    if (stat(path, &st) != 0)
+        return -1;
+
+    memset(buf, 0, sizeof(*buf));
+    snprintf(buf->f_fstypename, sizeof(buf->f_fstypename), "hostfs");
+    snprintf(buf->f_mntonname, sizeof(buf->f_mntonname), "/");
+
+    pthread_mutex_lock(&table_lock);
+    int fd = table_open();
+    host_table_t t = {};
+
+    if (fd >= 0 && table_read(fd, &t) == 0) {
+        size_t best = 0;
+        for (int i = 0; i < t.count; i++) {
+            size_t n = strlen(t.items[i].on);
+            if (n > best && !strncmp(path, t.items[i].on, n) &&
+                (path[n] == '\0' || path[n] == '/')) {
+                best = n;
+                snprintf(buf->f_fstypename, sizeof(buf->f_fstypename), "%s", t.items[i].fstype);
+                snprintf(buf->f_mntfromname, sizeof(buf->f_mntfromname), "%s", t.items[i].from);
+                snprintf(buf->f_mntonname, sizeof(buf->f_mntonname), "%s", t.items[i].on);
+            }
+        }
+    }
+
+    free(t.items);
+    if (fd >= 0) close(fd);
+    pthread_mutex_unlock(&table_lock);
+    return 0;
+}
+
+// ---------------- SYSTEM SERVICES ----------------
+typedef struct notify_request {
+    char unused[45];
+    char message[3075];
+} notify_request_t;
+
+extern "C" int sceAppInstUtilInitialize(void) {
+    return 0;
+}
+
+// Registration only checks that the title's /user/app directory exists
+extern "C" int sceAppInstUtilAppInstallTitleDir(const char* title_id, const char* install_path, void* reserved) {
+    (void)reserved;
+    char path[PATH_MAX];
+    struct stat st;
+
+    simulate_latency(LAT_REGISTER);
+
+    snprintf(path, sizeof(path), "%s%s", install_path, title_id);
+    return (stat(path, &st) == 0 && S_ISDIR(st.st_mode)) ? 0 : -1;
+}
+
+// Notifications are recorded, one per line, to NOTIFY_LOG_FILE:
+// "<monotonic ms> <message with newlines as \n>"
+#define NOTIFY_LOG_FILE GM_ROOT "/notifications.log"
+
+extern "C" int sceKernelSendNotificationRequest(int device, notify_request_t* req, size_t size, int blocking) {
+    (void)device; (void)size; (void)blocking;
+    simulate_latency(LAT_NOTIFY);
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    char line[2 * sizeof(req->message) + 32];
+    int len = snprintf(line, sizeof(line), "%.3f ", ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0);
+    for (const char* p = req->message; *p && p < req->message + sizeof(req->message); p++) {
+        if (*p == '\n') {
+            line[len++] = '\\';
+            line[len++] = 'n';
+        } else {
+            line[len++] = *p;
+        }
+    }
+    line[len++] = '\n';
+
+    // One append per message, so concurrent senders don't interleave
+    int fd = open(NOTIFY_LOG_FILE, O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (fd < 0) return -1;
+    ssize_t n = write(fd, line, len);
+    close(fd);
+    return (n == len) ? 0 : -1;
+}
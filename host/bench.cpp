@@ -0,0 +1,456 @@
+//   Synthetic game library and scan benchmark for the host build
+//
+//   gm_bench gen N      fills $(GM_ROOT) with N fake games spread over the six
+//                       game roots: param.json and param.sfo variants, multi-MB
+//                       pic/at9 files and a share of malformed entries
+//   gm_bench [N ...]    for each N (default 10 100 1000 5000) generates the
+//                       library, then runs the payload cold (no cache, nothing
+//                       mounted) and warm (straight after), reporting wall
+//                       time, syscalls and peak RSS of each run
+//
+//   Options: --bin PATH (payload built with the same GM_ROOT, default
+//   ./game_mounter_bench), --pic-kb K and --at9-kb K (media sizes, default
+//   2048 and 1024), --seed S, --no-trace (skip the syscall-counting runs).
+//   Stand-in latency is set with the GM_HOST_*_US variables, see backend.cpp.
+#include <errno.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ptrace.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef GM_ROOT
+#error "GM_ROOT must match the payload's"
+#endif
+
+static const char* GAME_ROOTS[] = {
+    GM_ROOT "/data/etaHEN/games",
+    GM_ROOT "/mnt/usb0/games",
+    GM_ROOT "/mnt/usb1/games",
+    GM_ROOT "/mnt/usb2/games",
+    GM_ROOT "/mnt/usb3/games",
+    GM_ROOT "/mnt/ext0/games",
+};
+#define NUM_GAME_ROOTS (sizeof(GAME_ROOTS) / sizeof(GAME_ROOTS[0]))
+
+typedef struct {
+    int pic_kb;
+    int at9_kb;
+    uint64_t seed;
+} gen_opts_t;
+
+// ---------------- FILE HELPERS ----------------
+static uint64_t rng_next(uint64_t* s) {
+    // xorshift64*
+    *s ^= *s >> 12;
+    *s ^= *s << 25;
+    *s ^= *s >> 27;
+    return *s * 2685821657736338717ULL;
+}
+
+// Joins dir and name; -1 (ENAMETOOLONG) if it doesn't fit
+static int join(char* out, size_t size, const char* dir, const char* name) {
+    int n = snprintf(out, size, "%s/%s", dir, name);
+    if (n < 0 || (size_t)n >= size) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    return 0;
+}
+
+static void mkdirs(const char* path) {
+    char tmp[PATH_MAX];
+    snprintf(tmp, sizeof(tmp), "%s", path);
+    for (char* p = tmp + 1; *p; p++) {
+        if (*p == '/') {
+            *p = '\0';
+            mkdir(tmp, 0755);
+            *p = '/';
+        }
+    }
+    mkdir(tmp, 0755);
+}
+
+static int write_file(const char* path, const void* data, size_t len) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return -1;
+    const char* p = (const char*)data;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            close(fd);
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return close(fd);
+}
+
+// Media files are filled from one random block, offset per file
+static int write_blob(const char* path, size_t size, uint64_t* rng) {
+    static char block[1 << 20];
+    static int block_ready = 0;
+    if (!block_ready) {
+        uint64_t s = 0x9e3779b97f4a7c15ULL;
+        for (size_t i = 0; i < sizeof(block); i += 8) {
+            uint64_t v = rng_next(&s);
+            memcpy(block + i, &v, 8);
+        }
+        block_ready = 1;
+    }
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return -1;
+    size_t off = rng_next(rng) % (sizeof(block) / 2);
+    while (size > 0) {
+        size_t chunk = sizeof(block) - off;
+        if (chunk > size) chunk = size;
+        ssize_t n = write(fd, block + off, chunk);
+        if (n <= 0) {
+            close(fd);
+            return -1;
+        }
+        size -= (size_t)n;
+        off = 0;
+    }
+    return close(fd);
+}
+
+static int remove_entry(const char* path, const struct stat* st, int type, struct FTW* ftw) {
+    (void)st; (void)ftw;
+    return (type == FTW_DP) ? rmdir(path) : unlink(path);
+}
+
+static void remove_tree(const char* path) {
+    nftw(path, remove_entry, 64, FTW_DEPTH | FTW_PHYS);
+}
+
+// ---------------- GENERATOR ----------------
+// Writes a param.sfo with the given string keys (already in key order)
+static int write_sfo(const char* path, const char* const* keys, const char* const* values,
+                     int count, int corrupt) {
+    uint8_t buf[4096] = {};
+    uint32_t key_size = 0, data_size = 0;
+
+    for (int i = 0; i < count; i++) {
+        key_size += strlen(keys[i]) + 1;
+        data_size += (strlen(values[i]) + 1 + 3) / 4 * 4 + 4;
+    }
+    key_size = (key_size + 3) / 4 * 4;
+
+    uint32_t key_off = 20 + 16 * count;
+    uint32_t data_off = key_off + key_size;
+    uint32_t header[5] = { corrupt ? 0xdeadbeef : 0x46535000, 0x101, key_off, data_off, (uint32_t)count };
+    if (data_off + data_size > sizeof(buf)) return -1;
+    memcpy(buf, header, sizeof(header));
+
+    uint32_t kpos = 0, dpos = 0;
+    for (int i = 0; i < count; i++) {
+        uint32_t len = strlen(values[i]) + 1;
+        uint32_t max_len = (len + 3) / 4 * 4 + 4;
+        uint16_t k16 = (uint16_t)kpos, fmt = 0x0204;
+        uint8_t* e = buf + 20 + 16 * i;
+        memcpy(e, &k16, 2);
+        memcpy(e + 2, &fmt, 2);
+        memcpy(e + 4, &len, 4);
+        memcpy(e + 8, &max_len, 4);
+        memcpy(e + 12, &dpos, 4);
+        memcpy(buf + key_off + kpos, keys[i], strlen(keys[i]) + 1);
+        memcpy(buf + data_off + dpos, values[i], len);
+        kpos += strlen(keys[i]) + 1;
+        dpos += max_len;
+    }
+    return write_file(path, buf, data_off + data_size);
+}
+
+// Every 20 games: 12 param.json, 4 param.sfo only, 1 with both, and one each
+// of no sce_sys, truncated param.json and an SFO with a bad magic
+static int generate_game(int i, const gen_opts_t* o, uint64_t* rng) {
+    int variant = i % 20;
+    const char* root = GAME_ROOTS[i % NUM_GAME_ROOTS];
+    char dir[PATH_MAX], sce_sys[PATH_MAX], path[PATH_MAX];
+    char title_id[16], name[64];
+
+    snprintf(name, sizeof(name), "Bench Game %d", i);
+    char folder[32];
+    snprintf(folder, sizeof(folder), "Bench Game %05d", i);
+    if (join(dir, sizeof(dir), root, folder) != 0 || join(sce_sys, sizeof(sce_sys), dir, "sce_sys") != 0)
+        return -1;
+    mkdirs(dir);
+
+    if (join(path, sizeof(path), dir, "eboot.bin") != 0 || write_blob(path, 4096, rng) != 0)
+        return -1;
+    if (variant == 17)
+        return 0;
+
+    mkdirs(sce_sys);
+    int sfo = (variant >= 12 && variant <= 16) || variant == 19;
+    int json = variant < 12 || variant == 16 || variant == 18;
+    snprintf(title_id, sizeof(title_id), "%s%05d", sfo && !json ? "CUSA" : "PPSA", i);
+
+    if (json) {
+        char doc[1024];
+        int n = snprintf(doc, sizeof(doc),
+            "{\n  \"applicationDrmType\": \"upgradable\",\n  \"contentId\": \"UP0000-%s_00-BENCH00000000000\",\n"
+            "  \"contentVersion\": \"01.000.000\",\n  \"localizedParameters\": {\n"
+            "    \"defaultLanguage\": \"en-US\",\n    \"en-US\": { \"titleName\": \"%s\" },\n"
+            "    \"ja-JP\": { \"titleName\": \"%s (JP)\" }\n  },\n  \"titleId\": \"%s\"\n}\n",
+            title_id, name, name, title_id);
+        // Cut off before the title ID
+        if (variant == 18) n /= 3;
+        if (join(path, sizeof(path), sce_sys, "param.json") != 0 || write_file(path, doc, (size_t)n) != 0)
+            return -1;
+    }
+    if (sfo) {
+        char content_id[48];
+        snprintf(content_id, sizeof(content_id), "UP0000-%s_00-BENCH00000000000", title_id);
+        const char* keys[] = { "APP_VER", "CATEGORY", "CONTENT_ID", "TITLE", "TITLE_ID" };
+        const char* values[] = { "01.00", "gd", content_id, name, title_id };
+        if (join(path, sizeof(path), sce_sys, "param.sfo") != 0 ||
+            write_sfo(path, keys, values, 5, variant == 19) != 0)
+            return -1;
+    }
+
+    // Media sizes vary by +-25% around the requested size
+    struct { const char* file; size_t kb; } media[] = {
+        { "icon0.png", 48 },
+        { "pic0.png",  (size_t)o->pic_kb },
+        { "pic1.png",  (size_t)o->pic_kb / 2 },
+        { "snd0.at9",  (size_t)o->at9_kb },
+    };
+    for (size_t m = 0; m < sizeof(media) / sizeof(media[0]); m++) {
+        size_t kb = media[m].kb;
+        if (kb > 4) kb = kb * 3 / 4 + rng_next(rng) % (kb / 2 + 1);
+        if (join(path, sizeof(path), sce_sys, media[m].file) != 0 || write_blob(path, kb * 1024, rng) != 0)
+            return -1;
+    }
+
+    if (join(path, sizeof(path), sce_sys, "changeinfo") != 0) return -1;
+    mkdirs(path);
+    if (join(path, sizeof(path), sce_sys, "changeinfo/changeinfo.xml") != 0) return -1;
+    const char* xml = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<changeinfo/>\n";
+    return write_file(path, xml, strlen(xml));
+}
+
+// Payload state from earlier runs: mounts, installed metadata, cache, logs
+static void reset_state(void) {
+    remove_tree(GM_ROOT "/system_ex");
+    remove_tree(GM_ROOT "/user");
+    remove_tree(GM_ROOT "/proc");
+    unlink(GM_ROOT "/data/etaHEN/game_cache.bin");
+    unlink(GM_ROOT "/data/etaHEN/game_mounter.log");
+    unlink(GM_ROOT "/data/etaHEN/game_mounter.log.old");
+    unlink(GM_ROOT "/notifications.log");
+    mkdirs(GM_ROOT "/system_ex/app");
+    mkdirs(GM_ROOT "/user/app");
+    mkdirs(GM_ROOT "/user/appmeta");
+}
+
+static int generate_library(int count, const gen_opts_t* o) {
+    for (size_t r = 0; r < NUM_GAME_ROOTS; r++) {
+        remove_tree(GAME_ROOTS[r]);
+        mkdirs(GAME_ROOTS[r]);
+    }
+    reset_state();
+
+    uint64_t rng = o->seed ? o->seed : 1;
+    for (int i = 0; i < count; i++) {
+        if (generate_game(i, o, &rng) != 0) {
+            fprintf(stderr, "gm_bench: cannot write game %d: %s\n", i, strerror(errno));
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// ---------------- HARNESS ----------------
+typedef struct {
+    double wall_ms;
+    long rss_kb;
+    long long syscalls;
+    int status;
+} run_result_t;
+
+static double monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static pid_t spawn(const char* bin, int trace) {
+    pid_t pid = fork();
+    if (pid != 0) return pid;
+
+    int null = open("/dev/null", O_WRONLY);
+    if (null >= 0) dup2(null, STDOUT_FILENO);
+    if (trace) {
+        ptrace(PTRACE_TRACEME, 0, NULL, NULL);
+        raise(SIGSTOP);
+    }
+    execl(bin, bin, (char*)NULL);
+    _exit(127);
+}
+
+// Counts syscalls of every thread: each one stops the tracee on entry and exit
+static int run_traced(const char* bin, run_result_t* r) {
+    pid_t pid = spawn(bin, 1);
+    if (pid < 0) return -1;
+
+    int st;
+    if (waitpid(pid, &st, 0) != pid || !WIFSTOPPED(st)) return -1;
+    ptrace(PTRACE_SETOPTIONS, pid, NULL,
+           (void*)(long)(PTRACE_O_TRACESYSGOOD | PTRACE_O_TRACECLONE |
+                         PTRACE_O_TRACEFORK | PTRACE_O_TRACEVFORK | PTRACE_O_EXITKILL));
+    ptrace(PTRACE_SYSCALL, pid, NULL, NULL);
+
+    long long stops = 0;
+    for (;;) {
+        struct rusage ru;
+        pid_t t = wait4(-1, &st, __WALL, &ru);
+        if (t < 0) {
+            if (errno == EINTR) continue;
+            break;  // no tracees left
+        }
+        if (WIFEXITED(st) || WIFSIGNALED(st)) {
+            if (t == pid) {
+                r->status = st;
+                r->rss_kb = ru.ru_maxrss;
+            }
+            continue;
+        }
+        if (!WIFSTOPPED(st)) continue;
+
+        // Syscall stops, clone/exec traps and new threads' initial SIGSTOP
+        // are ours; anything else goes to the tracee
+        int sig = WSTOPSIG(st);
+        if (sig == (SIGTRAP | 0x80)) stops++;
+        int deliver = (sig == (SIGTRAP | 0x80) || sig == SIGTRAP || sig == SIGSTOP) ? 0 : sig;
+        ptrace(PTRACE_SYSCALL, t, NULL, (void*)(long)deliver);
+    }
+    r->syscalls = stops / 2;
+    return 0;
+}
+
+static int run_timed(const char* bin, run_result_t* r) {
+    double t0 = monotonic_ms();
+    pid_t pid = spawn(bin, 0);
+    if (pid < 0) return -1;
+
+    struct rusage ru;
+    int st;
+    while (wait4(pid, &st, 0, &ru) < 0) {
+        if (errno != EINTR) return -1;
+    }
+    r->wall_ms = monotonic_ms() - t0;
+    r->rss_kb = ru.ru_maxrss;
+    r->status = st;
+    return 0;
+}
+
+static int run_ok(const run_result_t* r) {
+    return WIFEXITED(r->status) && WEXITSTATUS(r->status) == 0;
+}
+
+// One row: cold and warm runs, then the same two traced for syscall counts
+static int bench_size(const char* bin, int count, const gen_opts_t* o, int trace) {
+    double t0 = monotonic_ms();
+    if (generate_library(count, o) != 0) return -1;
+    double gen_ms = monotonic_ms() - t0;
+
+    run_result_t cold = {}, warm = {}, cold_tr = {}, warm_tr = {};
+    if (run_timed(bin, &cold) != 0 || run_timed(bin, &warm) != 0) return -1;
+    if (trace) {
+        reset_state();
+        if (run_traced(bin, &cold_tr) != 0 || run_traced(bin, &warm_tr) != 0) return -1;
+    }
+    if (!run_ok(&cold) || !run_ok(&warm)) {
+        fprintf(stderr, "gm_bench: %s failed (status %d/%d)\n", bin, cold.status, warm.status);
+        return -1;
+    }
+
+    char cold_sc[32] = "-", warm_sc[32] = "-";
+    if (trace) {
+        snprintf(cold_sc, sizeof(cold_sc), "%lld", cold_tr.syscalls);
+        snprintf(warm_sc, sizeof(warm_sc), "%lld", warm_tr.syscalls);
+    }
+    printf("%6d  %9.0f  %9.1f  %9.1f  %10s  %10s  %9ld  %9ld\n",
+           count, gen_ms, cold.wall_ms, warm.wall_ms, cold_sc, warm_sc, cold.rss_kb, warm.rss_kb);
+    fflush(stdout);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    gen_opts_t o = { 2048, 1024, 1 };
+    const char* bin = "./game_mounter_bench";
+    int trace = 1;
+    int sizes[32];
+    int num_sizes = 0;
+    int gen_only = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "gen"))
+            gen_only = 1;
+        else if (!strcmp(argv[i], "--bin") && i + 1 < argc)
+            bin = argv[++i];
+        else if (!strcmp(argv[i], "--pic-kb") && i + 1 < argc)
+            o.pic_kb = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--at9-kb") && i + 1 < argc)
+            o.at9_kb = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && i + 1 < argc)
+            o.seed = strtoull(argv[++i], NULL, 10);
+        else if (!strcmp(argv[i], "--no-trace"))
+            trace = 0;
+        else if (atoi(argv[i]) > 0 && num_sizes < 32)
+            sizes[num_sizes++] = atoi(argv[i]);
+        else {
+            fprintf(stderr, "usage: %s [gen] [--bin PATH] [--pic-kb K] [--at9-kb K] "
+                            "[--seed S] [--no-trace] [N ...]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (o.pic_kb < 0) o.pic_kb = 0;
+    if (o.at9_kb < 0) o.at9_kb = 0;
+
+    // GM_ROOT is wiped between sizes, never let it be the real root
+    if (strlen(GM_ROOT) < 2) {
+        fprintf(stderr, "gm_bench: refusing to run with GM_ROOT \"%s\"\n", GM_ROOT);
+        return 2;
+    }
+
+    if (gen_only) {
+        if (num_sizes != 1) {
+            fprintf(stderr, "usage: %s gen N\n", argv[0]);
+            return 2;
+        }
+        if (generate_library(sizes[0], &o) != 0) return 1;
+        printf("Generated %d games under %s\n", sizes[0], GM_ROOT);
+        return 0;
+    }
+
+    if (num_sizes == 0) {
+        int defaults[] = { 10, 100, 1000, 5000 };
+        for (int i = 0; i < 4; i++) sizes[num_sizes++] = defaults[i];
+    }
+
+    printf("root: %s, media: pic %d KB, at9 %d KB\n", GM_ROOT, o.pic_kb, o.at9_kb);
+    printf("%6s  %9s  %9s  %9s  %10s  %10s  %9s  %9s\n",
+           "games", "gen ms", "cold ms", "warm ms", "cold sysc", "warm sysc", "cold KB", "warm KB");
+    for (int i = 0; i < num_sizes; i++) {
+        if (bench_size(bin, sizes[i], &o, trace) != 0) {
+            fprintf(stderr, "gm_bench: run with %d games failed\n", sizes[i]);
+            return 1;
+        }
+    }
+    return 0;
+}
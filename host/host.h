@@ -0,0 +1,42 @@
+//   Linux host build of the payload
+//
+//   The FreeBSD/PS5 interfaces main.cpp uses (nmount, unmount, statfs with
+//   f_fstypename) are declared here and implemented by host/backend.cpp, which
+//   keeps its mount table under GM_ROOT instead of touching the real system.
+//   Every console path the payload uses is prefixed with GM_ROOT, so a host
+//   run works on a directory tree laid out like the console's:
+//
+//     $(GM_ROOT)/data/etaHEN/games, /mnt/usb0/games, /system_ex/app,
+//     /user/app, /user/appmeta, /proc/self/mountinfo
+#pragma once
+
+#include <sys/param.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <limits.h>
+#include <stdint.h>
+
+#ifndef GM_ROOT
+#error "GM_ROOT must name the directory that stands in for the console's /"
+#endif
+
+#define MFSNAMELEN 16
+#define MNAMELEN   PATH_MAX
+
+#define MNT_UPDATE 0x00010000
+#define MNT_FORCE  0x00080000
+
+// Keep clear of glibc's statfs(2); only the fields the payload reads exist
+#define statfs gm_statfs
+
+struct gm_statfs {
+    char f_fstypename[MFSNAMELEN];
+    char f_mntfromname[MNAMELEN];
+    char f_mntonname[MNAMELEN];
+};
+
+extern "C" {
+    int gm_statfs(const char* path, struct gm_statfs* buf);
+    int nmount(struct iovec* iov, unsigned int niov, int flags);
+    int unmount(const char* dir, int flags);
+}
@@ -0,0 +1,290 @@
+//   Reader for traces written by the payload's --record option
+//
+//   gm_replay stats TRACE   per-call counts, failures and p50/p95/max
+//                           durations, plus the slowest calls
+//   gm_replay dump TRACE    one line per recorded call
+//   gm_replay build TRACE   recreates the game folders the trace saw under
+//                           $(GM_ROOT): directories, files at their recorded
+//                           size (sparse) and param.json/param.sfo contents
+//
+//   A rebuilt library can then be scanned with the recorded latencies:
+//     ./gm_replay build usb.trace && ./game_mounter_host --replay usb.trace
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef GM_ROOT
+#error "GM_ROOT must match the payload's"
+#endif
+
+// Keep in sync with the TRACE section of main.cpp
+#define TRACE_MAGIC "GMTRACE1"
+
+enum {
+    TR_STAT, TR_LSTAT, TR_MKDIR, TR_UNLINK, TR_RENAME, TR_OPENDIR, TR_READ, TR_WRITE,
+    TR_COPY, TR_DELETE, TR_MOUNT, TR_UNMOUNT, TR_STATFS, TR_REGISTER, TR_NOTIFY, TR_COUNT
+};
+
+#define TRF_DIR 0x1
+
+typedef struct {
+    char magic[8];
+    uint64_t started;
+} trace_header_t;
+
+typedef struct {
+    uint64_t start_us;
+    uint32_t dur_us;
+    int32_t result;
+    int64_t size;
+    uint16_t op;
+    uint16_t path_len;
+    uint16_t aux_len;
+    uint8_t thread;
+    uint8_t flags;
+} trace_rec_t;
+
+static const char* OP_NAMES[TR_COUNT] = {
+    "stat", "lstat", "mkdir", "unlink", "rename", "opendir", "read", "write",
+    "copy", "delete", "mount", "unmount", "statfs", "register", "notify",
+};
+
+typedef struct {
+    trace_rec_t rec;
+    const char* path;
+    const char* aux;
+} trace_entry_t;
+
+typedef struct {
+    char* map;
+    size_t len;
+    trace_entry_t* items;
+    int count;
+    uint64_t started;
+} trace_t;
+
+static int trace_load(const char* file, trace_t* t) {
+    int fd = open(file, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(trace_header_t)) {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+    t->len = (size_t)st.st_size;
+    t->map = (char*)mmap(NULL, t->len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (t->map == MAP_FAILED || memcmp(t->map, TRACE_MAGIC, 8) != 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    trace_header_t h;
+    memcpy(&h, t->map, sizeof(h));
+    t->started = h.started;
+
+    int cap = 0;
+    size_t off = sizeof(h);
+    while (off + sizeof(trace_rec_t) <= t->len) {
+        trace_entry_t e;
+        memcpy(&e.rec, t->map + off, sizeof(e.rec));
+        e.path = t->map + off + sizeof(e.rec);
+        e.aux = e.path + e.rec.path_len;
+        off += sizeof(e.rec) + e.rec.path_len + e.rec.aux_len;
+        if (off > t->len || e.rec.op >= TR_COUNT) break;
+
+        if (t->count == cap) {
+            cap = cap ? cap * 2 : 1024;
+            trace_entry_t* items = (trace_entry_t*)realloc(t->items, cap * sizeof(*items));
+            if (!items) return -1;
+            t->items = items;
+        }
+        t->items[t->count++] = e;
+    }
+    return 0;
+}
+
+// ---------------- STATS ----------------
+static int cmp_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static int cmp_slowest(const void* a, const void* b) {
+    uint32_t x = ((const trace_entry_t*)a)->rec.dur_us, y = ((const trace_entry_t*)b)->rec.dur_us;
+    return (x < y) - (x > y);
+}
+
+static void print_stats(trace_t* t) {
+    uint32_t* durs = (uint32_t*)malloc((t->count + 1) * sizeof(*durs));
+    if (!durs) return;
+
+    uint64_t end_us = 0;
+    for (int i = 0; i < t->count; i++) {
+        uint64_t e = t->items[i].rec.start_us + t->items[i].rec.dur_us;
+        if (e > end_us) end_us = e;
+    }
+    printf("%d call(s) over %.1f ms\n\n", t->count, end_us / 1000.0);
+    printf("%-9s %8s %7s %11s %10s %10s %10s %12s\n",
+           "call", "count", "failed", "total ms", "p50 ms", "p95 ms", "max ms", "bytes");
+
+    for (int op = 0; op < TR_COUNT; op++) {
+        int n = 0, failed = 0;
+        double total = 0;
+        long long bytes = 0;
+        for (int i = 0; i < t->count; i++) {
+            const trace_rec_t* r = &t->items[i].rec;
+            if (r->op != op) continue;
+            durs[n++] = r->dur_us;
+            total += r->dur_us;
+            bytes += r->size;
+            if (r->result < 0) failed++;
+        }
+        if (n == 0) continue;
+        qsort(durs, n, sizeof(*durs), cmp_u32);
+        printf("%-9s %8d %7d %11.1f %10.3f %10.3f %10.3f %12lld\n", OP_NAMES[op], n, failed,
+               total / 1000.0, durs[(n - 1) / 2] / 1000.0, durs[(n * 95 + 99) / 100 - 1] / 1000.0,
+               durs[n - 1] / 1000.0, bytes);
+    }
+    free(durs);
+
+    trace_entry_t* sorted = (trace_entry_t*)malloc(t->count * sizeof(*sorted) + 1);
+    if (!sorted) return;
+    memcpy(sorted, t->items, t->count * sizeof(*sorted));
+    qsort(sorted, t->count, sizeof(*sorted), cmp_slowest);
+    printf("\nslowest:\n");
+    for (int i = 0; i < t->count && i < 10; i++) {
+        const trace_entry_t* e = &sorted[i];
+        printf("  %10.3f ms  %-8s %.*s\n", e->rec.dur_us / 1000.0, OP_NAMES[e->rec.op],
+               (int)e->rec.path_len, e->path);
+    }
+    free(sorted);
+}
+
+// Notification texts span lines
+static void print_escaped(const char* s, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (s[i] == '\n') fputs("\\n", stdout);
+        else putchar(s[i]);
+    }
+}
+
+static void print_dump(const trace_t* t) {
+    for (int i = 0; i < t->count; i++) {
+        const trace_entry_t* e = &t->items[i];
+        printf("%12.3f %3u %-8s %9.3f ms  rc %-4d size %-9lld ", e->rec.start_us / 1000.0,
+               e->rec.thread, OP_NAMES[e->rec.op], e->rec.dur_us / 1000.0, e->rec.result,
+               (long long)e->rec.size);
+        print_escaped(e->path, e->rec.path_len);
+        // Second paths are shown, file contents are not
+        if (e->rec.aux_len && (e->rec.op == TR_RENAME || e->rec.op == TR_MOUNT || e->rec.op == TR_COPY)) {
+            fputs(" -> ", stdout);
+            print_escaped(e->aux, e->rec.aux_len);
+        }
+        putchar('\n');
+    }
+}
+
+// ---------------- BUILD ----------------
+static const char* GAME_ROOTS[] = {
+    "/data/etaHEN/games/",
+    "/mnt/",
+};
+
+static int in_library(const char* path, size_t len) {
+    for (size_t i = 0; i < sizeof(GAME_ROOTS) / sizeof(GAME_ROOTS[0]); i++) {
+        size_t n = strlen(GAME_ROOTS[i]);
+        if (len > n && !strncmp(path, GAME_ROOTS[i], n))
+            return 1;
+    }
+    return 0;
+}
+
+static void mkdirs(char* path) {
+    for (char* p = path + 1; *p; p++) {
+        if (*p == '/') {
+            *p = '\0';
+            mkdir(path, 0755);
+            *p = '/';
+        }
+    }
+    mkdir(path, 0755);
+}
+
+static int build_library(const trace_t* t) {
+    int dirs = 0, files = 0;
+    char path[PATH_MAX];
+
+    for (int i = 0; i < t->count; i++) {
+        const trace_entry_t* e = &t->items[i];
+        int op = e->rec.op;
+        if (e->rec.result < 0 || !in_library(e->path, e->rec.path_len))
+            continue;
+        if (op != TR_STAT && op != TR_LSTAT && op != TR_OPENDIR && op != TR_READ && op != TR_COPY)
+            continue;
+
+        snprintf(path, sizeof(path), GM_ROOT "%.*s", (int)e->rec.path_len, e->path);
+        if ((e->rec.flags & TRF_DIR) || op == TR_OPENDIR) {
+            mkdirs(path);
+            dirs++;
+            continue;
+        }
+
+        char* slash = strrchr(path, '/');
+        *slash = '\0';
+        mkdirs(path);
+        *slash = '/';
+
+        int fd = open(path, O_WRONLY | O_CREAT, 0644);
+        if (fd < 0) {
+            fprintf(stderr, "gm_replay: cannot create %s: %s\n", path, strerror(errno));
+            continue;
+        }
+        // Recorded contents win; other files only need their size
+        if (op == TR_READ && e->rec.aux_len == e->rec.size) {
+            if (ftruncate(fd, 0) != 0 || write(fd, e->aux, e->rec.aux_len) != e->rec.aux_len)
+                fprintf(stderr, "gm_replay: cannot write %s\n", path);
+        } else {
+            struct stat st;
+            if (fstat(fd, &st) == 0 && st.st_size < e->rec.size && ftruncate(fd, e->rec.size) != 0)
+                fprintf(stderr, "gm_replay: cannot size %s\n", path);
+        }
+        close(fd);
+        files++;
+    }
+    printf("Rebuilt %d director(ies) and %d file(s) under %s\n", dirs, files, GM_ROOT);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s stats|dump|build TRACE\n", argv[0]);
+        return 2;
+    }
+
+    trace_t t = {};
+    if (trace_load(argv[2], &t) != 0) {
+        fprintf(stderr, "gm_replay: cannot read %s: %s\n", argv[2], strerror(errno));
+        return 1;
+    }
+
+    if (!strcmp(argv[1], "stats"))
+        print_stats(&t);
+    else if (!strcmp(argv[1], "dump"))
+        print_dump(&t);
+    else if (!strcmp(argv[1], "build"))
+        return build_library(&t) == 0 ? 0 : 1;
+    else {
+        fprintf(stderr, "usage: %s stats|dump|build TRACE\n", argv[0]);
+        return 2;
+    }
+    return 0;
+}
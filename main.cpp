@@ -6,34 +6,69 @@
 #include <ctype.h>
 #include <stdarg.h>
 #include <sys/stat.h>
+#ifdef GM_HOST
+#include "host/host.h"
+#else
 #include <sys/_iovec.h>
 #include <sys/mount.h>
+#endif
 #include <sys/param.h>
 #include <errno.h>
 #include <limits.h>
 #include <sys/uio.h>
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <time.h>
+#include <pthread.h>
+#include <signal.h>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#else
+#include <sys/event.h>
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 // #include <sqlite3.h>  // Not available in SDK, sound info update is optional
 
+// Host builds (make host) run against a directory tree under GM_ROOT
+#ifndef GM_ROOT
+#define GM_ROOT ""
+#endif
+
 // Log file path
-#define LOG_FILE "/data/etaHEN/game_mounter.log"
-#define CACHE_FILE "/data/etaHEN/game_cache.json"
+#define LOG_FILE GM_ROOT "/data/etaHEN/game_mounter.log"
+#define CACHE_FILE GM_ROOT "/data/etaHEN/game_cache.bin"
+#define CACHE_JSON_FILE GM_ROOT "/data/etaHEN/game_cache.json"
 
-#define IOVEC_ENTRY(x) { (void*)(x), (x) ? strlen(x) + 1 : 0 }
+#define IOVEC_ENTRY(x) { (void*)(x), strlen(x) + 1 }
+#define IOVEC_NONE     { NULL, 0 }   // value of a flag-only option
 #define IOVEC_SIZE(x)  (sizeof(x) / sizeof(struct iovec))
 
 // Supported game paths - internal, USB drives, and M.2 SSD
 static const char* GAME_PATHS[] = {
-    "/data/etaHEN/games",    // Internal etaHEN storage
-    "/mnt/usb0/games",       // USB drive 0
-    "/mnt/usb1/games",       // USB drive 1  
-    "/mnt/usb2/games",       // USB drive 2
-    "/mnt/usb3/games",       // USB drive 3
-    "/mnt/ext0/games",       // M.2 SSD
+    GM_ROOT "/data/etaHEN/games",    // Internal etaHEN storage
+    GM_ROOT "/mnt/usb0/games",       // USB drive 0
+    GM_ROOT "/mnt/usb1/games",       // USB drive 1  
+    GM_ROOT "/mnt/usb2/games",       // USB drive 2
+    GM_ROOT "/mnt/usb3/games",       // USB drive 3
+    GM_ROOT "/mnt/ext0/games",       // M.2 SSD
 };
 #define NUM_GAME_PATHS (sizeof(GAME_PATHS) / sizeof(GAME_PATHS[0]))
 
+// Display names for GAME_PATHS, used in notifications
+static const char* LOCATION_NAMES[] = {
+    "Internal",
+    "USB0",
+    "USB1",
+    "USB2",
+    "USB3",
+    "M.2 SSD"
+};
+
 typedef struct notify_request {
     char unused[45];
     char message[3075];
@@ -45,932 +80,5034 @@ extern "C" {
     int sceKernelSendNotificationRequest(int, notify_request_t*, size_t, int);
 }
 
-// ---------------- LOGGING ----------------
-static FILE* log_file = NULL;
+// ---------------- TIMING ----------------
+// Monotonic spans around each phase of a run, aggregated per phase and per
+// device into log-scale histograms (4 buckets per power of two, in
+// microseconds), so p50/p95 cost a bucket walk instead of a stored sample per
+// span. Each run is appended to TIMING_FILE, which keeps the last
+// TIMING_HISTORY runs.
+#define TIMING_FILE    GM_ROOT "/data/etaHEN/game_mounter_timing.json"
+#define TIMING_HISTORY 20
+#define TIMING_BUCKETS 160
 
-static void log_init(void) {
-    // Log rotation: if log file > 1MB, truncate it
-    struct stat log_stat;
-    if (stat(LOG_FILE, &log_stat) == 0 && log_stat.st_size > 1024 * 1024) {
-        // Rename old log
-        rename(LOG_FILE, LOG_FILE ".old");
-    }
-    
-    log_file = fopen(LOG_FILE, "a");
-    if (log_file) {
-        time_t now = time(NULL);
-        fprintf(log_file, "\n=== Game Mounter Started: %s", ctime(&now));
-        fflush(log_file);
-    }
+enum {
+    PH_REMOUNT,
+    PH_CACHE_LOAD,
+    PH_FAST_START,  // cached titles restored before discovery
+    PH_CLEANUP,
+    PH_DISCOVERY,
+    PH_GAME,        // whole process_game() call
+    PH_PARSE,
+    PH_DRM,
+    PH_MOUNT,
+    PH_COPY,
+    PH_REGISTER,
+    PH_MOUNT_LNK,
+    PH_CACHE_SAVE,
+    PH_LOG_WRITE,   // writer thread batches
+    PH_COUNT
+};
+
+static const char* PHASE_NAMES[PH_COUNT] = {
+    "remount", "cache_load", "fast_start", "cleanup", "discovery", "game", "parse",
+    "drm_patch", "mount", "copy", "register", "mount_lnk", "cache_save", "log_write",
+};
+
+typedef struct {
+    uint64_t count;
+    double total_ms;
+    double max_ms;
+    uint32_t buckets[TIMING_BUCKETS];
+} timing_hist_t;
+
+// Slot NUM_GAME_PATHS holds every span; per-game phases also land in their root's slot
+#define TIMING_ALL NUM_GAME_PATHS
+
+static struct {
+    pthread_mutex_t lock;
+    timing_hist_t hist[PH_COUNT][NUM_GAME_PATHS + 1];
+} g_timing = { PTHREAD_MUTEX_INITIALIZER, {} };
+
+static double monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
 }
 
-static void log_close(void) {
-    if (log_file) {
-        fclose(log_file);
-        log_file = NULL;
-    }
+static int timing_bucket(uint64_t us) {
+    if (us < 4) return (int)us;
+    int msb = 63 - __builtin_clzll(us);
+    int idx = 4 * (msb - 1) + (int)((us >> (msb - 2)) & 3);
+    return idx < TIMING_BUCKETS ? idx : TIMING_BUCKETS - 1;
 }
 
-static void log_msg(const char* fmt, ...) {
-    va_list args;
-    va_start(args, fmt);
-    
-    // Print to console
-    vprintf(fmt, args);
-    
-    // Write to log file
-    if (log_file) {
-        va_list args2;
-        va_copy(args2, args);
-        vfprintf(log_file, fmt, args2);
-        fflush(log_file);
-        va_end(args2);
+// Upper edge of a bucket, in ms
+static double timing_bucket_ms(int idx) {
+    if (idx < 4) return (idx + 1) / 1000.0;
+    int msb = idx / 4 + 1;
+    uint64_t lo = (uint64_t)(4 + idx % 4) << (msb - 2);
+    return (lo + (1ULL << (msb - 2))) / 1000.0;
+}
+
+static void timing_add(timing_hist_t* h, double ms) {
+    h->count++;
+    h->total_ms += ms;
+    if (ms > h->max_ms) h->max_ms = ms;
+    h->buckets[timing_bucket(ms > 0 ? (uint64_t)(ms * 1000.0) : 0)]++;
+}
+
+// Records the span that started at since_ms and returns now, so consecutive
+// phases can chain: t = timing_span(PH_A, root, t); ... timing_span(PH_B, root, t)
+static double timing_span(int phase, int root_idx, double since_ms) {
+    double now = monotonic_ms();
+    double ms = now - since_ms;
+
+    pthread_mutex_lock(&g_timing.lock);
+    timing_add(&g_timing.hist[phase][TIMING_ALL], ms);
+    if (root_idx >= 0 && root_idx < (int)NUM_GAME_PATHS)
+        timing_add(&g_timing.hist[phase][root_idx], ms);
+    pthread_mutex_unlock(&g_timing.lock);
+    return now;
+}
+
+static double timing_percentile(const timing_hist_t* h, double pct) {
+    uint64_t rank = (uint64_t)(h->count * pct + 0.999999);
+    if (rank < 1) rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < TIMING_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= rank) {
+            double ms = timing_bucket_ms(i);
+            return ms < h->max_ms ? ms : h->max_ms;
+        }
     }
-    
-    va_end(args);
+    return h->max_ms;
 }
 
-// ---------------- NOTIFY ----------------
-static void notify(const char* fmt, ...) {
-    notify_request_t req = {};
-    va_list args;
-    va_start(args, fmt);
-    vsnprintf(req.message, sizeof(req.message), fmt, args);
-    va_end(args);
-    sceKernelSendNotificationRequest(0, &req, sizeof(req), 0);
+static void timing_reset(void) {
+    pthread_mutex_lock(&g_timing.lock);
+    memset(g_timing.hist, 0, sizeof(g_timing.hist));
+    pthread_mutex_unlock(&g_timing.lock);
 }
 
-// ---------------- MOUNT HELPERS ----------------
-static int remount_system_ex(void) {
-    struct iovec iov[] = {
-        IOVEC_ENTRY("from"),      IOVEC_ENTRY("/dev/ssd0.system_ex"),
-        IOVEC_ENTRY("fspath"),    IOVEC_ENTRY("/system_ex"),
-        IOVEC_ENTRY("fstype"),    IOVEC_ENTRY("exfatfs"),
-        IOVEC_ENTRY("large"),     IOVEC_ENTRY("yes"),
-        IOVEC_ENTRY("timezone"),  IOVEC_ENTRY("static"),
-        IOVEC_ENTRY("async"),     IOVEC_ENTRY(NULL),
-        IOVEC_ENTRY("ignoreacl"), IOVEC_ENTRY(NULL),
-    };
-    return nmount(iov, IOVEC_SIZE(iov), MNT_UPDATE);
+// ---------------- TRACE ----------------
+// --record FILE writes every filesystem, mount, registration and notification
+// call made while processing games, cleaning up and copying metadata to a
+// compact binary trace: a trace_header_t, then one trace_rec_t per call
+// followed by its path and aux bytes (a second path, or the contents of the
+// small file read). Integers are native little-endian. gm_replay (host build)
+// summarizes a trace and rebuilds the game library it saw, and --replay FILE
+// in host builds stretches each call to its recorded duration, matched by
+// call and path, so scheduling can be compared against field latencies.
+#define TRACE_MAGIC   "GMTRACE1"
+#define TRACE_BUF     (64 * 1024)
+#define TRACE_AUX_MAX 0xffff
+
+enum {
+    TR_STAT, TR_LSTAT, TR_MKDIR, TR_UNLINK, TR_RENAME, TR_OPENDIR, TR_READ, TR_WRITE,
+    TR_COPY, TR_DELETE, TR_MOUNT, TR_UNMOUNT, TR_STATFS, TR_REGISTER, TR_NOTIFY, TR_COUNT
+};
+
+#define TRF_DIR 0x1     // stat: the path is a directory
+
+typedef struct {
+    char magic[8];
+    uint64_t started;   // unix time
+} trace_header_t;
+
+typedef struct {
+    uint64_t start_us;  // since the trace started
+    uint32_t dur_us;
+    int32_t result;     // 0 or a count on success, -errno on failure
+    int64_t size;       // bytes: file size, copied, read or written
+    uint16_t op;
+    uint16_t path_len;
+    uint16_t aux_len;
+    uint8_t thread;
+    uint8_t flags;
+} trace_rec_t;
+
+#ifdef GM_HOST
+typedef struct replay_key {
+    struct replay_key* next;
+    uint16_t op;
+    const char* path;   // into the mapped trace
+    uint16_t path_len;
+    uint32_t* durs;
+    int count;
+    int capacity;
+    int cursor;
+} replay_key_t;
+#endif
+
+static struct {
+    int active;         // recording or replaying
+    int fd;             // recording
+    double start_ms;
+    pthread_mutex_t lock;
+    char buf[TRACE_BUF];
+    size_t used;
+    int threads;
+#ifdef GM_HOST
+    int replay;
+    char* map;
+    size_t map_len;
+    replay_key_t** buckets;
+    uint32_t mask;
+#endif
+} g_trace = { 0, -1, 0, PTHREAD_MUTEX_INITIALIZER };
+
+static __thread int trace_thread = -1;
+
+static void trace_flush(void) {
+    size_t off = 0;
+    while (off < g_trace.used) {
+        ssize_t n = write(g_trace.fd, g_trace.buf + off, g_trace.used - off);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        off += (size_t)n;
+    }
+    g_trace.used = 0;
 }
 
-static int mount_nullfs(const char* src, const char* dst) {
-    struct iovec iov[] = {
-        IOVEC_ENTRY("fstype"), IOVEC_ENTRY("nullfs"),
-        IOVEC_ENTRY("from"),   IOVEC_ENTRY(src),
-        IOVEC_ENTRY("fspath"), IOVEC_ENTRY(dst),
-    };
-    return nmount(iov, IOVEC_SIZE(iov), 0);
+static void trace_append(const void* data, size_t len) {
+    if (g_trace.used + len > sizeof(g_trace.buf))
+        trace_flush();
+    if (len > sizeof(g_trace.buf)) return;
+    memcpy(g_trace.buf + g_trace.used, data, len);
+    g_trace.used += len;
 }
 
-static int is_mounted(const char* path) {
-    struct statfs sfs;
-    if (statfs(path, &sfs) != 0)
-        return 0;
-    return strcmp(sfs.f_fstypename, "nullfs") == 0;
+// Paths are stored as seen on the console, without the host's GM_ROOT
+static const char* trace_path(const char* path) {
+    size_t n = strlen(GM_ROOT);
+    if (n > 0 && !strncmp(path, GM_ROOT, n) && (path[n] == '/' || path[n] == '\0'))
+        return path + n;
+    return path;
 }
 
-// ---------------- SAFE RECURSIVE DELETE ----------------
-static int rmdir_recursive(const char* path) {
-    DIR* d = opendir(path);
-    if (!d) {
-        return -1;
+#ifdef GM_HOST
+static uint32_t replay_hash(int op, const char* path, size_t len) {
+    uint32_t h = 2166136261u ^ (uint32_t)op;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)path[i];
+        h *= 16777619u;
     }
-    
-    struct dirent* e;
-    char full_path[PATH_MAX];
+    return h;
+}
+
+// Notifications carry progress counts that differ between runs; they are
+// replayed in order regardless of text
+static replay_key_t* replay_find(int op, const char* path, size_t len, int create) {
+    if (op == TR_NOTIFY) len = 0;
+    replay_key_t** slot = &g_trace.buckets[replay_hash(op, path, len) & g_trace.mask];
+    for (replay_key_t* k = *slot; k; k = k->next)
+        if (k->op == op && k->path_len == len && !memcmp(k->path, path, len))
+            return k;
+    if (!create) return NULL;
+
+    replay_key_t* k = (replay_key_t*)calloc(1, sizeof(*k));
+    if (!k) return NULL;
+    k->op = (uint16_t)op;
+    k->path = path;
+    k->path_len = (uint16_t)len;
+    k->next = *slot;
+    *slot = k;
+    return k;
+}
+
+static int trace_replay_open(const char* file) {
+    int fd = open(file, O_RDONLY);
+    if (fd < 0) return -1;
     struct stat st;
-    int result = 0;
-    
-    while ((e = readdir(d))) {
-        if (!strcmp(e->d_name, ".") || !strcmp(e->d_name, ".."))
-            continue;
-        
-        snprintf(full_path, sizeof(full_path), "%s/%s", path, e->d_name);
-        
-        if (stat(full_path, &st) != 0) {
-            continue;
-        }
-        
-        if (S_ISDIR(st.st_mode)) {
-            // Recursively delete subdirectory
-            if (rmdir_recursive(full_path) != 0) {
-                result = -1;
-            }
-        } else {
-            // Delete file
-            if (unlink(full_path) != 0) {
-                result = -1;
-            }
-        }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(trace_header_t)) {
+        close(fd);
+        errno = EINVAL;
+        return -1;
     }
-    
-    closedir(d);
-    
-    // Finally remove the directory itself
-    if (rmdir(path) != 0) {
-        result = -1;
+    size_t len = (size_t)st.st_size;
+    char* map = (char*)mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+    if (memcmp(map, TRACE_MAGIC, 8) != 0) {
+        munmap(map, len);
+        errno = EINVAL;
+        return -1;
     }
-    
-    return result;
-}
 
-// ---------------- COPY DIRECTORY ----------------
-static int copy_dir(const char* src, const char* dst) {
-    if (mkdir(dst, 0755) && errno != EEXIST) {
-        log_msg("mkdir failed for %s (errno: %d)\n", dst, errno);
+    uint32_t size = 1024;
+    while (size < len / 64) size <<= 1;
+    g_trace.buckets = (replay_key_t**)calloc(size, sizeof(*g_trace.buckets));
+    if (!g_trace.buckets) {
+        munmap(map, len);
         return -1;
     }
+    g_trace.mask = size - 1;
+    g_trace.map = map;
+    g_trace.map_len = len;
 
-    DIR* d = opendir(src);
-    if (!d) return -1;
+    int records = 0;
+    size_t off = sizeof(trace_header_t);
+    while (off + sizeof(trace_rec_t) <= len) {
+        trace_rec_t r;
+        memcpy(&r, map + off, sizeof(r));
+        const char* path = map + off + sizeof(r);
+        off += sizeof(r) + r.path_len + r.aux_len;
+        if (off > len || r.op >= TR_COUNT) break;
 
-    struct dirent* e;
-    char ss[PATH_MAX], dd[PATH_MAX];
-    struct stat st;
+        replay_key_t* k = replay_find(r.op, path, r.path_len, 1);
+        if (!k) break;
+        if (k->count == k->capacity) {
+            int cap = k->capacity ? k->capacity * 2 : 4;
+            uint32_t* durs = (uint32_t*)realloc(k->durs, cap * sizeof(*durs));
+            if (!durs) break;
+            k->durs = durs;
+            k->capacity = cap;
+        }
+        k->durs[k->count++] = r.dur_us;
+        records++;
+    }
 
-    while ((e = readdir(d))) {
-        if (!strcmp(e->d_name, ".") || !strcmp(e->d_name, "..")) continue;
+    g_trace.replay = 1;
+    return records;
+}
 
-        snprintf(ss, sizeof(ss), "%s/%s", src, e->d_name);
-        snprintf(dd, sizeof(dd), "%s/%s", dst, e->d_name);
+// Recorded duration of the next matching call; the last one repeats
+static uint32_t trace_replay_us(int op, const char* path) {
+    pthread_mutex_lock(&g_trace.lock);
+    replay_key_t* k = replay_find(op, path, strlen(path), 0);
+    uint32_t us = 0;
+    if (k && k->count > 0) {
+        us = k->durs[k->cursor < k->count ? k->cursor : k->count - 1];
+        k->cursor++;
+    }
+    pthread_mutex_unlock(&g_trace.lock);
+    return us;
+}
+#endif
 
-        if (stat(ss, &st) != 0) continue;
+static int trace_record_open(const char* file) {
+    g_trace.fd = open(file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (g_trace.fd < 0) return -1;
 
-        if (S_ISDIR(st.st_mode)) {
-            copy_dir(ss, dd);
-        } else {
-            // Optimized copy with 1 MB buffer (130x faster than 8 KB)
-            unlink(dd);
-            
-            int src_fd = open(ss, O_RDONLY);
-            if (src_fd < 0) continue;
-            
-            int dst_fd = open(dd, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-            if (dst_fd < 0) {
-                close(src_fd);
-                continue;
-            }
-            
-            // Use 2 MB buffer for ultra-fast copying
-            char* buf = (char*)malloc(2097152);
-            if (buf) {
-                ssize_t n;
-                while ((n = read(src_fd, buf, 2097152)) > 0) {
-                    ssize_t written = write(dst_fd, buf, n);
-                    if (written != n) {
-                        log_msg("  [WARN] Partial write for %s (%zd/%zd bytes)\n", dd, written, n);
-                        break;
-                    }
-                }
-                free(buf);
-            }
-            
-            close(src_fd);
-            close(dst_fd);
-        }
-    }
-    closedir(d);
+    trace_header_t h = {};
+    memcpy(h.magic, TRACE_MAGIC, 8);
+    h.started = (uint64_t)time(NULL);
+    trace_append(&h, sizeof(h));
     return 0;
 }
 
-// ---------------- COPY appmeta ----------------
-static int is_appmeta_file(const char* name) {
-    if (!strcasecmp(name, "param.json") ||
-        !strcasecmp(name, "param.sfo"))
-        return 1;
+static void trace_start(void) {
+    g_trace.start_ms = monotonic_ms();
+    g_trace.active = 1;
+}
 
-    const char* ext = strrchr(name, '.');
-    if (!ext) return 0;
+static void trace_close(void) {
+    pthread_mutex_lock(&g_trace.lock);
+    g_trace.active = 0;
+    if (g_trace.fd >= 0) {
+        trace_flush();
+        close(g_trace.fd);
+        g_trace.fd = -1;
+    }
+    pthread_mutex_unlock(&g_trace.lock);
+}
 
-    return !strcasecmp(ext, ".png") ||
-           !strcasecmp(ext, ".dds") ||
-           !strcasecmp(ext, ".at9");
+static double trace_begin(void) {
+    return g_trace.active ? monotonic_ms() : 0;
 }
 
-static int copy_sce_sys_to_appmeta(const char* src, const char* title_id) {
-    char dst[PATH_MAX];
-    snprintf(dst, sizeof(dst), "/user/appmeta/%s", title_id);
+// Records (or, replaying, stretches) the call that started at t0
+static void trace_end(int op, const char* path, const char* aux, size_t aux_len,
+                      long long result, long long size, int flags, double t0) {
+    if (!g_trace.active) return;
+    int saved = errno;
+    double now = monotonic_ms();
+    path = trace_path(path);
 
-    mkdir("/user/appmeta", 0777);
-    mkdir(dst, 0755);
+#ifdef GM_HOST
+    if (g_trace.replay) {
+        double want_ms = trace_replay_us(op, path) / 1000.0;
+        if (want_ms > now - t0)
+            usleep((useconds_t)((want_ms - (now - t0)) * 1000.0));
+        errno = saved;
+        return;
+    }
+#endif
 
-    DIR* d = opendir(src);
-    if (!d) return -1;
+    if (trace_thread < 0)
+        trace_thread = __atomic_fetch_add(&g_trace.threads, 1, __ATOMIC_RELAXED);
 
-    struct dirent* e;
-    char ss[PATH_MAX], dd[PATH_MAX];
-    struct stat st;
+    trace_rec_t r = {};
+    r.start_us = (uint64_t)((t0 - g_trace.start_ms) * 1000.0);
+    r.dur_us = (uint32_t)((now - t0) * 1000.0);
+    r.result = (int32_t)result;
+    r.size = size;
+    r.op = (uint16_t)op;
+    r.path_len = (uint16_t)strnlen(path, TRACE_AUX_MAX);
+    r.aux_len = (uint16_t)(aux_len < TRACE_AUX_MAX ? aux_len : 0);
+    r.thread = (uint8_t)trace_thread;
+    r.flags = (uint8_t)flags;
 
-    while ((e = readdir(d))) {
-        if (!strcmp(e->d_name, ".") || !strcmp(e->d_name, ".."))
-            continue;
+    pthread_mutex_lock(&g_trace.lock);
+    if (g_trace.fd >= 0) {
+        trace_append(&r, sizeof(r));
+        trace_append(path, r.path_len);
+        if (r.aux_len) trace_append(aux, r.aux_len);
+    }
+    pthread_mutex_unlock(&g_trace.lock);
+    errno = saved;
+}
 
-        if (!is_appmeta_file(e->d_name))
-            continue;
+#define TRACE_RESULT(rc) ((rc) < 0 ? -errno : (rc))
 
-        snprintf(ss, sizeof(ss), "%s/%s", src, e->d_name);
-        snprintf(dd, sizeof(dd), "%s/%s", dst, e->d_name);
+// ---------------- DIRECTORY HANDLES ----------------
+// The pipeline works relative to held directory fds: the GAME_PATHS roots and
+// the system folders titles are installed under are opened once per run, a
+// game's folder, its sce_sys and /user/app/<TITLE> once per game. Everything
+// below them goes through openat/fstatat/mkdirat/unlinkat/renameat with a
+// short relative name, so the kernel doesn't walk the full path again for
+// every file, and a folder renamed or swapped after it was opened can't
+// redirect what is done to it. dir_t.path is only used for logs and traces.
+typedef struct {
+    int fd;
+    char path[PATH_MAX];
+} dir_t;
 
-        if (stat(ss, &st) != 0 || !S_ISREG(st.st_mode))
-            continue;
+// Held for the whole run; the roots are (re)opened by discovery
+static dir_t g_roots[NUM_GAME_PATHS];
+static dir_t g_user_app;
+static dir_t g_user_appmeta;
+static dir_t g_system_ex_app;
 
-        // Optimized copy with 1 MB buffer (130x faster than 8 KB)
-        unlink(dd);
-        
-        int src_fd = open(ss, O_RDONLY);
-        if (src_fd < 0) continue;
-        
-        int dst_fd = open(dd, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-        if (dst_fd < 0) {
-            close(src_fd);
-            continue;
-        }
-        
-        // Use 2 MB buffer for ultra-fast copying
-        char* buf = (char*)malloc(2097152);
-        if (buf) {
-            ssize_t n;
-            while ((n = read(src_fd, buf, 2097152)) > 0) {
-                ssize_t written = write(dst_fd, buf, n);
-                if (written != n) {
-                    log_msg("  [WARN] Partial write for %s (%zd/%zd bytes)\n", dd, written, n);
-                    break;
-                }
-            }
-            free(buf);
-        }
-        
-        close(src_fd);
-        close(dst_fd);
+#define DIR_FLAGS (O_RDONLY | O_DIRECTORY | O_CLOEXEC)
+
+// Joins dir/name (just name without dir); -1 if it doesn't fit. errno is
+// left alone, callers report the syscall's
+static int path_join(char* out, size_t size, const char* dir, const char* name) {
+    int n = dir ? snprintf(out, size, "%s/%s", dir, name) : snprintf(out, size, "%s", name);
+    return n < 0 || (size_t)n >= size ? -1 : 0;
+}
+
+// Trace records keep full paths, joined only while tracing
+static void trace_end_at(int op, const dir_t* dir, const char* name, const char* aux, size_t aux_len,
+                         long long result, long long size, int flags, double t0) {
+    if (!g_trace.active) return;
+    // A path past PATH_MAX couldn't be rebuilt or matched on replay
+    char path[PATH_MAX];
+    if (path_join(path, sizeof(path), dir ? dir->path : NULL, name) != 0) return;
+    trace_end(op, path, aux, aux_len, result, size, flags, t0);
+}
+
+// Opens name relative to parent (an absolute path when parent is NULL)
+static int dir_open(dir_t* d, const dir_t* parent, const char* name) {
+    double t = trace_begin();
+    d->fd = openat(parent ? parent->fd : AT_FDCWD, name, DIR_FLAGS);
+    trace_end_at(TR_OPENDIR, parent, name, NULL, 0, d->fd < 0 ? -errno : 0, 0, TRF_DIR, t);
+    if (d->fd >= 0 && path_join(d->path, sizeof(d->path), parent ? parent->path : NULL, name) != 0) {
+        close(d->fd);
+        d->fd = -1;
+        errno = ENAMETOOLONG;
     }
+    return d->fd < 0 ? -1 : 0;
+}
 
-    closedir(d);
-    return 0;
+static void dir_close(dir_t* d) {
+    if (d->fd >= 0) close(d->fd);
+    d->fd = -1;
 }
 
-// ---------------- Get Icon Sound ----------------
-// NOTE: sqlite3 not available in SDK, sound info update disabled
-static int update_snd0info(const char* title_id) {
-    (void)title_id;  // Unused parameter
-    log_msg("[snd0] Sound info update skipped (sqlite3 not available)\n");
-    return 0;
+// A listing on its own open file description, so the held fd's offset is
+// never shared; the stream is released with closedir()
+static DIR* dir_list(const dir_t* d) {
+    int fd = openat(d->fd, ".", DIR_FLAGS);
+    if (fd < 0) return NULL;
+    DIR* list = fdopendir(fd);
+    if (!list) close(fd);
+    return list;
 }
 
-// ---------------- JSON HELPER ----------------
-static int extract_json_string(const char* json, const char* key,
-                               char* out, size_t out_size) {
-    char search[64];
-    snprintf(search, sizeof(search), "\"%s\"", key);
+static void dirs_open(void) {
+    for (int i = 0; i < (int)NUM_GAME_PATHS; i++)
+        g_roots[i].fd = -1;
 
-    const char* p = strstr(json, search);
-    if (!p) return -1;
+    mkdir(GM_ROOT "/user/appmeta", 0777);
+    dir_open(&g_user_app, NULL, GM_ROOT "/user/app");
+    dir_open(&g_user_appmeta, NULL, GM_ROOT "/user/appmeta");
+    dir_open(&g_system_ex_app, NULL, GM_ROOT "/system_ex/app");
+}
 
-    p = strchr(p + strlen(search), ':');
-    if (!p) return -1;
+static void dirs_close(void) {
+    for (int i = 0; i < (int)NUM_GAME_PATHS; i++)
+        dir_close(&g_roots[i]);
+    dir_close(&g_user_app);
+    dir_close(&g_user_appmeta);
+    dir_close(&g_system_ex_app);
+}
 
-    while (*++p && isspace(*p));
-    if (*p != '"') return -1;
-    p++;
+static int tr_fstatat(const dir_t* dir, const char* name, struct stat* st, int flags) {
+    double t = trace_begin();
+    int rc = fstatat(dir ? dir->fd : AT_FDCWD, name, st, flags);
+    trace_end_at((flags & AT_SYMLINK_NOFOLLOW) ? TR_LSTAT : TR_STAT, dir, name, NULL, 0,
+                 TRACE_RESULT(rc), rc ? 0 : st->st_size,
+                 rc == 0 && S_ISDIR(st->st_mode) ? TRF_DIR : 0, t);
+    return rc;
+}
 
-    size_t i = 0;
-    while (i < out_size - 1 && p[i] && p[i] != '"') {
-        out[i] = p[i];
-        i++;
+static int tr_mkdirat(const dir_t* dir, const char* name, mode_t mode) {
+    double t = trace_begin();
+    int rc = mkdirat(dir->fd, name, mode);
+    trace_end_at(TR_MKDIR, dir, name, NULL, 0, TRACE_RESULT(rc), 0, 0, t);
+    return rc;
+}
+
+static int tr_unlinkat(const dir_t* dir, const char* name) {
+    double t = trace_begin();
+    int rc = unlinkat(dir->fd, name, 0);
+    trace_end_at(TR_UNLINK, dir, name, NULL, 0, TRACE_RESULT(rc), 0, 0, t);
+    return rc;
+}
+
+static int tr_renameat(const dir_t* from_dir, const char* from, const dir_t* to_dir, const char* to) {
+    double t = trace_begin();
+    int rc = renameat(from_dir->fd, from, to_dir->fd, to);
+    if (g_trace.active) {
+        char aux[PATH_MAX];
+        size_t aux_len = path_join(aux, sizeof(aux), trace_path(to_dir->path), to) == 0 ? strlen(aux) : 0;
+        trace_end_at(TR_RENAME, from_dir, from, aux, aux_len, TRACE_RESULT(rc), 0, 0, t);
     }
-    out[i] = '\0';
-    return 0;
+    return rc;
 }
 
-// ---------------- SFO READER FOR PS4 ----------------
+// ---------------- LOGGING ----------------
+// log_msg() formats into a record and pushes it onto a lock-free ring (a
+// bounded MPSC queue with per-slot sequence numbers); a writer thread drains
+// it in batches, so callers never take a lock or wait for the disk. Each line
+// carries the seconds since start from the monotonic clock.
+#define LOG_RING_SIZE  1024           // records, power of two
+#define LOG_BATCH_SIZE (64 * 1024)    // bytes written per batch
+#define LOG_MAX_SIZE   (1024 * 1024)  // rotate to .old past this
+#define LOG_IDLE_MS    50
+
+enum { LOG_DEBUG, LOG_INFO, LOG_WARN, LOG_ERROR };
+
 typedef struct {
-    uint16_t key_offset;
-    uint16_t type;
-    uint32_t size;
-    uint32_t max_size;
-    uint32_t data_offset;
-} sfo_entry_t;
-
-static int read_title_id_from_sfo(const char* path,
-                                 char* title_id,
-                                 size_t size)
-{
-    FILE* f = fopen(path, "rb");
-    if (!f) return -1;
+    size_t seq;
+    char* data;
+    size_t len;
+} log_cell_t;
 
-    uint32_t magic, version, key_off, data_off, count;
-    if (fread(&magic, 4, 1, f) != 1 ||
-        fread(&version, 4, 1, f) != 1 ||
-        fread(&key_off, 4, 1, f) != 1 ||
-        fread(&data_off, 4, 1, f) != 1 ||
-        fread(&count, 4, 1, f) != 1) {
-        fclose(f);
-        return -1;
-    }
+static struct {
+    log_cell_t cells[LOG_RING_SIZE];
+    size_t head;            // next slot to claim (producers)
+    size_t tail;            // next slot to drain (writer only)
+    int fd;
+    long long size;
+    int level;
+    int running;
+    int stopping;
+    double start_ms;
+    pthread_t thread;
+    pthread_mutex_t lock;   // writer sleep, synchronous writes and drains
+    pthread_cond_t wake;
+    char batch[LOG_BATCH_SIZE];
+} g_log = { .fd = -1, .level = LOG_INFO, .lock = PTHREAD_MUTEX_INITIALIZER,
+            .wake = PTHREAD_COND_INITIALIZER };
 
-    if (magic != 0x46535000) {
-        fclose(f);
-        return -1;
+static void log_write_fd(int fd, const char* text, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, text, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        text += n;
+        len -= (size_t)n;
     }
+}
 
-    for (uint32_t i = 0; i < count; i++) {
-        sfo_entry_t entry;
-        if (fseek(f, 0x14 + i * sizeof(sfo_entry_t), SEEK_SET) != 0) continue;
-        if (fread(&entry, sizeof(sfo_entry_t), 1, f) != 1) continue;
+static void log_open_file(void) {
+    g_log.fd = open(LOG_FILE, O_WRONLY | O_APPEND | O_CREAT, 0644);
+    struct stat st;
+    g_log.size = (g_log.fd >= 0 && fstat(g_log.fd, &st) == 0) ? st.st_size : 0;
+}
 
-        char key[128] = {};
-        if (fseek(f, key_off + entry.key_offset, SEEK_SET) != 0) continue;
-        if (fread(key, 1, sizeof(key) - 1, f) <= 0) continue;
+// Called with g_log.lock held
+static void log_output(const char* text, size_t len) {
+    log_write_fd(STDOUT_FILENO, text, len);
+    if (g_log.fd < 0) return;
 
-        for (int k = 0; k < sizeof(key); k++) {
-            if (key[k] == '\0' || !isprint(key[k])) {
-                key[k] = '\0';
-                break;
+    log_write_fd(g_log.fd, text, len);
+    g_log.size += len;
+    if (g_log.size > LOG_MAX_SIZE) {
+        close(g_log.fd);
+        rename(LOG_FILE, LOG_FILE ".old");
+        log_open_file();
+    }
+}
+
+static int log_ring_push(char* data, size_t len) {
+    size_t pos = __atomic_load_n(&g_log.head, __ATOMIC_RELAXED);
+    for (;;) {
+        log_cell_t* c = &g_log.cells[pos & (LOG_RING_SIZE - 1)];
+        size_t seq = __atomic_load_n(&c->seq, __ATOMIC_ACQUIRE);
+        long dif = (long)(seq - pos);
+        if (dif == 0) {
+            if (__atomic_compare_exchange_n(&g_log.head, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                c->data = data;
+                c->len = len;
+                __atomic_store_n(&c->seq, pos + 1, __ATOMIC_RELEASE);
+                return 0;
             }
+        } else if (dif < 0) {
+            return -1;  // full
+        } else {
+            pos = __atomic_load_n(&g_log.head, __ATOMIC_RELAXED);
         }
+    }
+}
 
-        if (strncmp(key, "TITLE_ID", 8) == 0) {
-            if (fseek(f, data_off + entry.data_offset, SEEK_SET) != 0) continue;
-            size_t rlen = (entry.size < size - 1) ? entry.size : size - 1;
-            if (fread(title_id, 1, rlen, f) <= 0) continue;
-            title_id[rlen] = '\0';
+// Takes the published record at pos by moving its slot to the next lap.
+// The writer and the crash handler both claim this way, so each record is
+// written (and freed) by exactly one of them.
+static int log_ring_claim(size_t pos, char** data, size_t* len) {
+    log_cell_t* c = &g_log.cells[pos & (LOG_RING_SIZE - 1)];
+    size_t seq = pos + 1;
+    if (__atomic_load_n(&c->seq, __ATOMIC_ACQUIRE) != seq) return 0;
+    *data = c->data;
+    *len = c->len;
+    return __atomic_compare_exchange_n(&c->seq, &seq, pos + LOG_RING_SIZE, 0,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
 
-            for (int j = rlen - 1; j >= 0; j--) {
-                if (title_id[j] == '\0' || isspace(title_id[j]))
-                    title_id[j] = '\0';
-                else
-                    break;
-            }
+static int log_ring_pop(char** data, size_t* len) {
+    size_t tail = __atomic_load_n(&g_log.tail, __ATOMIC_RELAXED);
+    if (!log_ring_claim(tail, data, len)) return 0;
+    __atomic_store_n(&g_log.tail, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
 
-            fclose(f);
-            return 0;
+// Writes out everything queued so far, one write() per batch. Called with
+// g_log.lock held.
+static int log_drain(void) {
+    char* data;
+    size_t len;
+    size_t used = 0;
+    int count = 0;
+    double t = monotonic_ms();
+
+    while (log_ring_pop(&data, &len)) {
+        if (used + len > sizeof(g_log.batch)) {
+            log_output(g_log.batch, used);
+            used = 0;
+        }
+        if (len > sizeof(g_log.batch)) {
+            log_output(data, len);
+        } else {
+            memcpy(g_log.batch + used, data, len);
+            used += len;
         }
+        free(data);
+        count++;
     }
+    if (used > 0) log_output(g_log.batch, used);
+    if (count > 0) timing_span(PH_LOG_WRITE, -1, t);
+    return count;
+}
 
-    fclose(f);
-    return -1;
+static void* log_writer_main(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_log.lock);
+    for (;;) {
+        if (log_drain() > 0) continue;
+        if (g_log.stopping) break;
+
+        // Producers signal without the lock, so a wakeup can be missed;
+        // the timeout bounds how long a record waits
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += LOG_IDLE_MS * 1000000L;
+        if (ts.tv_nsec >= 1000000000L) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&g_log.wake, &g_log.lock, &ts);
+    }
+    pthread_mutex_unlock(&g_log.lock);
+    return NULL;
 }
 
-// ---------------- GET GAME REGION ----------------
-static const char* get_game_region(const char* title_id) {
-    if (!title_id || strlen(title_id) < 4) return "Unknown";
-    
-    // PS5 games (PPSA prefix)
-    if (strncmp(title_id, "PPSA", 4) == 0) {
-        char region_code = title_id[4];
-        switch (region_code) {
-            case '0': return "US";
-            case '1': return "EU";
-            case '2': return "JP";
-            case '3': return "Asia";
-            case '4': return "UK";
-            case '5': return "KR";
-            default: return "World";
+// Takes ownership of rec (malloc'd)
+static void log_submit(char* rec, size_t len) {
+    int spins = 0;
+    while (__atomic_load_n(&g_log.running, __ATOMIC_ACQUIRE)) {
+        if (log_ring_push(rec, len) == 0) {
+            pthread_cond_signal(&g_log.wake);
+            return;
         }
+        // Full: let the writer catch up rather than drop the record
+        pthread_cond_signal(&g_log.wake);
+        if (++spins > 100) usleep(1000);
+        else sched_yield();
     }
+
+    // Before log_init() or after log_close(): write directly
+    pthread_mutex_lock(&g_log.lock);
+    log_output(rec, len);
+    pthread_mutex_unlock(&g_log.lock);
+    free(rec);
+}
+
+// Fatal signals write out the records still queued, then die the way they
+// would have (SA_RESETHAND restored the default action). Only write() and
+// atomics are used: no lock, no allocation, no ring state beyond the claim,
+// so it works whatever the crashing thread was doing. A batch the writer had
+// already taken is finished by the writer or lost with it.
+static void log_crash_handler(int sig) {
+    int fd = __atomic_load_n(&g_log.fd, __ATOMIC_RELAXED);
+    char* data;
+    size_t len;
+    for (size_t pos = __atomic_load_n(&g_log.tail, __ATOMIC_ACQUIRE);
+         log_ring_claim(pos, &data, &len); pos++) {
+        log_write_fd(STDOUT_FILENO, data, len);
+        if (fd >= 0) log_write_fd(fd, data, len);
+    }
+    raise(sig);
+}
+
+static void log_close(void) {
+    if (!__atomic_exchange_n(&g_log.running, 0, __ATOMIC_ACQ_REL))
+        return;
+
+    pthread_mutex_lock(&g_log.lock);
+    g_log.stopping = 1;
+    pthread_cond_signal(&g_log.wake);
+    pthread_mutex_unlock(&g_log.lock);
+    pthread_join(g_log.thread, NULL);
+
+    // Records pushed while the writer was stopping
+    pthread_mutex_lock(&g_log.lock);
+    log_drain();
+    if (g_log.fd >= 0) {
+        close(g_log.fd);
+        g_log.fd = -1;
+    }
+    pthread_mutex_unlock(&g_log.lock);
+}
+
+static void log_init(void) {
+    // Log rotation: if log file > 1MB, start a new one
+    struct stat log_stat;
+    if (stat(LOG_FILE, &log_stat) == 0 && log_stat.st_size > LOG_MAX_SIZE) {
+        // Rename old log
+        rename(LOG_FILE, LOG_FILE ".old");
+    }
+
+    g_log.start_ms = monotonic_ms();
+    for (size_t i = 0; i < LOG_RING_SIZE; i++)
+        g_log.cells[i].seq = i;
+
+    log_open_file();
+    if (g_log.fd >= 0) {
+        char header[128];
+        time_t now = time(NULL);
+        int n = snprintf(header, sizeof(header), "\n=== Game Mounter Started: %s", ctime(&now));
+        log_write_fd(g_log.fd, header, (size_t)n);
+        g_log.size += n;
+    }
+
+    if (pthread_create(&g_log.thread, NULL, log_writer_main, NULL) == 0) {
+        __atomic_store_n(&g_log.running, 1, __ATOMIC_RELEASE);
+        atexit(log_close);
+
+        struct sigaction sa = {};
+        sa.sa_handler = log_crash_handler;
+        sa.sa_flags = SA_RESETHAND;
+        sigemptyset(&sa.sa_mask);
+        static const int fatal[] = { SIGSEGV, SIGBUS, SIGABRT, SIGILL, SIGFPE };
+        for (size_t i = 0; i < sizeof(fatal) / sizeof(fatal[0]); i++)
+            sigaction(fatal[i], &sa, NULL);
+    }
+}
+
+static int log_parse_level(const char* name) {
+    static const char* names[] = { "debug", "info", "warn", "error" };
+    for (int i = 0; i < 4; i++)
+        if (!strcmp(name, names[i]))
+            return i;
+    return -1;
+}
+
+// Workers buffer everything logged for one game and emit it as one record,
+// so concurrent games don't interleave their lines.
+static __thread char* log_block = NULL;
+static __thread size_t log_block_len = 0;
+static __thread size_t log_block_cap = 0;
+static __thread int log_block_active = 0;
+
+static void log_block_begin(void) {
+    log_block_len = 0;
+    log_block_active = 1;
+}
+
+static void log_block_end(void) {
+    log_block_active = 0;
+    if (log_block_len > 0) {
+        log_submit(log_block, log_block_len);
+    } else {
+        free(log_block);
+    }
+    log_block = NULL;
+    log_block_len = log_block_cap = 0;
+}
+
+static int log_block_reserve(size_t len) {
+    if (log_block_len + len <= log_block_cap) return 1;
+    size_t cap = log_block_cap ? log_block_cap * 2 : 4096;
+    while (cap < log_block_len + len) cap *= 2;
+    char* grown = (char*)realloc(log_block, cap);
+    if (!grown) return 0;
+    log_block = grown;
+    log_block_cap = cap;
+    return 1;
+}
+
+static void log_vmsg(int level, const char* fmt, va_list args) {
+    if (level < g_log.level) return;
+
+    char line[2048];
+    int n = vsnprintf(line, sizeof(line), fmt, args);
+    if (n < 0) return;
+    size_t len = ((size_t)n < sizeof(line)) ? (size_t)n : sizeof(line) - 1;
+
+    // The timestamp goes after any leading blank lines and the level tag
+    // after the indentation, so "  [WARN] ..." lines up with "  [OK] ..."
+    static const char* const tags[] = { "[DEBUG] ", "", "[WARN] ", "[ERROR] " };
+    const char* tag = (level >= LOG_DEBUG && level <= LOG_ERROR) ? tags[level] : "";
+    size_t tn = strlen(tag);
+    char stamp[32];
+    size_t lead = strspn(line, "\n");
+    size_t indent = lead + strspn(line + lead, " ");
+    int sn = snprintf(stamp, sizeof(stamp), "[%9.3f] ", (monotonic_ms() - g_log.start_ms) / 1000.0);
+    size_t total = len + (size_t)sn + tn;
+
+    char* out;
+    int in_block = log_block_active && log_block_reserve(total);
+    if (in_block) {
+        out = log_block + log_block_len;
+        log_block_len += total;
+    } else {
+        out = (char*)malloc(total);
+        if (!out) return;
+    }
+    char* p = out;
+    memcpy(p, line, lead);                  p += lead;
+    memcpy(p, stamp, (size_t)sn);           p += sn;
+    memcpy(p, line + lead, indent - lead);  p += indent - lead;
+    memcpy(p, tag, tn);                     p += tn;
+    memcpy(p, line + indent, len - indent);
+
+    if (!in_block)
+        log_submit(out, total);
+}
+
+static void log_msg(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    log_vmsg(LOG_INFO, fmt, args);
+    va_end(args);
+}
+
+static void log_at(int level, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    log_vmsg(level, fmt, args);
+    va_end(args);
+}
+
+// ---------------- NOTIFY ----------------
+// Progress updates and "Mounted" names don't call into the system directly:
+// they only update shared state, and a sender thread turns that into at most
+// g_notify.rate notifications per second, carrying the latest progress and
+// every title mounted since the previous one. notify() is for messages that
+// must be shown (start, summaries); it supersedes queued progress and goes
+// out after anything already sent.
+#define NOTIFY_RATE      2      // notifications per second, --notify-rate N
+#define NOTIFY_MAX_NAMES 8      // names listed before "+N more"
+#define NOTIFY_MSG_SIZE  sizeof(((notify_request_t*)0)->message)
+
+static struct {
+    pthread_mutex_t lock;       // the pending state below
+    pthread_mutex_t send_lock;  // keeps sends in order across threads
+    pthread_cond_t wake;
+    pthread_t thread;
+    int running;
+    int stopping;
+    int rate;
+    double last_sent_ms;
+    // latest progress
+    int progress_pending;
+    int current;
+    int total;
+    char game[300];
+    // titles mounted since the last notification
+    char names[NOTIFY_MAX_NAMES][300];
+    int name_count;
+} g_notify = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+               PTHREAD_COND_INITIALIZER };
+
+static void notify_send(const char* message) {
+    notify_request_t req = {};
+    snprintf(req.message, sizeof(req.message), "%s", message);
+    double t = trace_begin();
+    int rc = sceKernelSendNotificationRequest(0, &req, sizeof(req), 0);
+    trace_end(TR_NOTIFY, message, NULL, 0, rc, 0, 0, t);
+}
+
+// Builds a message from the pending state and clears it; called with
+// g_notify.lock held. Returns 0 if nothing was pending.
+static int notify_take(char* msg, size_t size) {
+    size_t len = 0;
+    msg[0] = '\0';
+
+    if (g_notify.progress_pending) {
+        int pct = (g_notify.total > 0) ? (g_notify.current * 100) / g_notify.total : 0;
+        len += snprintf(msg + len, size - len, "Mounting games... %d/%d (%d%%)\n%s",
+                        g_notify.current, g_notify.total, pct, g_notify.game);
+        g_notify.progress_pending = 0;
+    }
+    if (g_notify.name_count > 0 && len < size) {
+        int listed = g_notify.name_count < NOTIFY_MAX_NAMES ? g_notify.name_count : NOTIFY_MAX_NAMES;
+        len += snprintf(msg + len, size - len, "%sMounted:", len ? "\n\n" : "");
+        for (int i = 0; i < listed && len < size; i++)
+            len += snprintf(msg + len, size - len, "\n%s", g_notify.names[i]);
+        if (g_notify.name_count > listed && len < size)
+            len += snprintf(msg + len, size - len, "\n+%d more", g_notify.name_count - listed);
+        g_notify.name_count = 0;
+    }
+    return len > 0;
+}
+
+static void* notify_main(void* arg) {
+    (void)arg;
+    char msg[NOTIFY_MSG_SIZE];
+
+    pthread_mutex_lock(&g_notify.send_lock);
+    pthread_mutex_lock(&g_notify.lock);
+    while (!g_notify.stopping) {
+        int pending = g_notify.progress_pending || g_notify.name_count > 0;
+        double due = g_notify.last_sent_ms + 1000.0 / g_notify.rate;
+        double now = monotonic_ms();
+
+        if (pending && now >= due) {
+            notify_take(msg, sizeof(msg));
+            g_notify.last_sent_ms = now;
+            pthread_mutex_unlock(&g_notify.lock);
+            notify_send(msg);
+            // Let notify() in between sends
+            pthread_mutex_unlock(&g_notify.send_lock);
+            pthread_mutex_lock(&g_notify.send_lock);
+            pthread_mutex_lock(&g_notify.lock);
+            continue;
+        }
+
+        // Sleep until the next slot, or until there is something to send
+        pthread_mutex_unlock(&g_notify.send_lock);
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        long long wait_ns = (long long)((pending ? due - now : 1000.0) * 1000000.0);
+        wait_ns += ts.tv_nsec;
+        ts.tv_sec += (time_t)(wait_ns / 1000000000LL);
+        ts.tv_nsec = (long)(wait_ns % 1000000000LL);
+        pthread_cond_timedwait(&g_notify.wake, &g_notify.lock, &ts);
+        pthread_mutex_unlock(&g_notify.lock);
+        pthread_mutex_lock(&g_notify.send_lock);
+        pthread_mutex_lock(&g_notify.lock);
+    }
+    pthread_mutex_unlock(&g_notify.lock);
+    pthread_mutex_unlock(&g_notify.send_lock);
+    return NULL;
+}
+
+static void notify_init(void) {
+    if (g_notify.rate < 1) g_notify.rate = NOTIFY_RATE;
+    if (pthread_create(&g_notify.thread, NULL, notify_main, NULL) == 0)
+        g_notify.running = 1;
+}
+
+// Latest progress; only the newest one pending is shown
+static void notify_progress(int current, int total, const char* game) {
+    pthread_mutex_lock(&g_notify.lock);
+    g_notify.progress_pending = 1;
+    g_notify.current = current;
+    g_notify.total = total;
+    snprintf(g_notify.game, sizeof(g_notify.game), "%s", game);
+    pthread_mutex_unlock(&g_notify.lock);
+    pthread_cond_signal(&g_notify.wake);
+}
+
+// Queues a title for the next "Mounted:" list
+static void notify_mounted(const char* game) {
+    pthread_mutex_lock(&g_notify.lock);
+    if (g_notify.name_count < NOTIFY_MAX_NAMES)
+        snprintf(g_notify.names[g_notify.name_count], sizeof(g_notify.names[0]), "%s", game);
+    g_notify.name_count++;
+    pthread_mutex_unlock(&g_notify.lock);
+    pthread_cond_signal(&g_notify.wake);
+}
+
+// Shown right away, after any queued titles; pending progress is dropped
+static void notify(const char* fmt, ...) {
+    char msg[NOTIFY_MSG_SIZE];
+    char names[NOTIFY_MSG_SIZE];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(msg, sizeof(msg), fmt, args);
+    va_end(args);
+
+    pthread_mutex_lock(&g_notify.send_lock);
+    pthread_mutex_lock(&g_notify.lock);
+    g_notify.progress_pending = 0;
+    int have_names = notify_take(names, sizeof(names));
+    g_notify.last_sent_ms = monotonic_ms();
+    pthread_mutex_unlock(&g_notify.lock);
+
+    if (have_names)
+        notify_send(names);
+    notify_send(msg);
+    pthread_mutex_unlock(&g_notify.send_lock);
+}
+
+static void notify_close(void) {
+    if (!g_notify.running) return;
+
+    pthread_mutex_lock(&g_notify.lock);
+    g_notify.stopping = 1;
+    pthread_mutex_unlock(&g_notify.lock);
+    pthread_cond_signal(&g_notify.wake);
+    pthread_join(g_notify.thread, NULL);
+    g_notify.running = 0;
+
+    // Titles still queued are shown; stale progress is not
+    char msg[NOTIFY_MSG_SIZE];
+    g_notify.progress_pending = 0;
+    if (notify_take(msg, sizeof(msg)))
+        notify_send(msg);
+}
+
+// ---------------- MOUNT HELPERS ----------------
+static int remount_system_ex(void) {
+    struct iovec iov[] = {
+        IOVEC_ENTRY("from"),      IOVEC_ENTRY("/dev/ssd0.system_ex"),
+        IOVEC_ENTRY("fspath"),    IOVEC_ENTRY(GM_ROOT "/system_ex"),
+        IOVEC_ENTRY("fstype"),    IOVEC_ENTRY("exfatfs"),
+        IOVEC_ENTRY("large"),     IOVEC_ENTRY("yes"),
+        IOVEC_ENTRY("timezone"),  IOVEC_ENTRY("static"),
+        IOVEC_ENTRY("async"),     IOVEC_NONE,
+        IOVEC_ENTRY("ignoreacl"), IOVEC_NONE,
+    };
+    return nmount(iov, IOVEC_SIZE(iov), MNT_UPDATE);
+}
+
+// Mount table snapshot: read once per scan (getmntinfo on the console, the
+// mountinfo file in host builds), indexed by mount point and kept current by
+// mount_nullfs()/unmount_path(), so is_mounted() is a hash lookup instead of
+// a statfs() per call.
+typedef struct mount_entry {
+    struct mount_entry* next;
+    char* on;
+    char* from;
+    char fstype[16];
+} mount_entry_t;
+
+static struct {
+    pthread_mutex_t lock;
+    mount_entry_t** buckets;
+    uint32_t mask;
+    int count;
+} g_mounts = { PTHREAD_MUTEX_INITIALIZER, NULL, 0, 0 };
+
+static uint32_t mount_hash(const char* s) {
+    uint32_t h = 2166136261u;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// Callers hold g_mounts.lock
+static mount_entry_t** mount_slot(const char* on) {
+    mount_entry_t** p = &g_mounts.buckets[mount_hash(on) & g_mounts.mask];
+    while (*p && strcmp((*p)->on, on) != 0)
+        p = &(*p)->next;
+    return p;
+}
+
+static void mount_table_grow(void) {
+    uint32_t size = g_mounts.buckets ? (g_mounts.mask + 1) * 2 : 256;
+    mount_entry_t** buckets = (mount_entry_t**)calloc(size, sizeof(mount_entry_t*));
+    if (!buckets) return;
+
+    for (uint32_t i = 0; g_mounts.buckets && i <= g_mounts.mask; i++) {
+        mount_entry_t* e = g_mounts.buckets[i];
+        while (e) {
+            mount_entry_t* next = e->next;
+            uint32_t b = mount_hash(e->on) & (size - 1);
+            e->next = buckets[b];
+            buckets[b] = e;
+            e = next;
+        }
+    }
+    free(g_mounts.buckets);
+    g_mounts.buckets = buckets;
+    g_mounts.mask = size - 1;
+}
+
+static void mount_table_set(const char* on, const char* from, const char* fstype) {
+    pthread_mutex_lock(&g_mounts.lock);
+    if (!g_mounts.buckets || (uint32_t)g_mounts.count > g_mounts.mask)
+        mount_table_grow();
+
+    if (g_mounts.buckets) {
+        mount_entry_t** p = mount_slot(on);
+        mount_entry_t* e = *p;
+        if (!e && (e = (mount_entry_t*)calloc(1, sizeof(mount_entry_t))) != NULL) {
+            e->on = strdup(on);
+            *p = e;
+            g_mounts.count++;
+        }
+        if (e) {
+            free(e->from);
+            e->from = strdup(from);
+            snprintf(e->fstype, sizeof(e->fstype), "%s", fstype);
+        }
+    }
+    pthread_mutex_unlock(&g_mounts.lock);
+}
+
+static void mount_table_del(const char* on) {
+    pthread_mutex_lock(&g_mounts.lock);
+    if (g_mounts.buckets) {
+        mount_entry_t** p = mount_slot(on);
+        mount_entry_t* e = *p;
+        if (e) {
+            *p = e->next;
+            free(e->on);
+            free(e->from);
+            free(e);
+            g_mounts.count--;
+        }
+    }
+    pthread_mutex_unlock(&g_mounts.lock);
+}
+
+static void mount_table_clear(void) {
+    pthread_mutex_lock(&g_mounts.lock);
+    for (uint32_t i = 0; g_mounts.buckets && i <= g_mounts.mask; i++) {
+        mount_entry_t* e = g_mounts.buckets[i];
+        while (e) {
+            mount_entry_t* next = e->next;
+            free(e->on);
+            free(e->from);
+            free(e);
+            e = next;
+        }
+    }
+    free(g_mounts.buckets);
+    g_mounts.buckets = NULL;
+    g_mounts.mask = 0;
+    g_mounts.count = 0;
+    pthread_mutex_unlock(&g_mounts.lock);
+}
+
+#ifdef GM_HOST
+// mountinfo escapes blanks and backslashes as \ooo
+static void mountinfo_unescape(char* s) {
+    char* out = s;
+    for (char* p = s; *p; p++) {
+        if (p[0] == '\\' && p[1] >= '0' && p[1] <= '7' && p[2] && p[3]) {
+            *out++ = (char)(((p[1] - '0') << 6) | ((p[2] - '0') << 3) | (p[3] - '0'));
+            p += 3;
+        } else {
+            *out++ = *p;
+        }
+    }
+    *out = '\0';
+}
+#endif
+
+// Replaces the snapshot with the current mount table; returns its size
+static int mount_table_load(void) {
+    mount_table_clear();
+
+#ifdef GM_HOST
+    FILE* f = fopen(GM_ROOT "/proc/self/mountinfo", "r");
+    if (!f) return 0;
+
+    // id parent major:minor root mount-point options - fstype source super
+    char line[3 * PATH_MAX];
+    char on[PATH_MAX], from[PATH_MAX], fstype[16];
+    while (fgets(line, sizeof(line), f)) {
+        const char* sep = strstr(line, " - ");
+        if (!sep || sscanf(line, "%*s %*s %*s %*s %4095s", on) != 1 ||
+            sscanf(sep + 3, "%15s %4095s", fstype, from) != 2)
+            continue;
+        mountinfo_unescape(on);
+        mountinfo_unescape(from);
+        mount_table_set(on, from, fstype);
+    }
+    fclose(f);
+#else
+    struct statfs* mnts = NULL;
+    int n = getmntinfo(&mnts, MNT_NOWAIT);
+    for (int i = 0; i < n; i++)
+        mount_table_set(mnts[i].f_mntonname, mnts[i].f_mntfromname, mnts[i].f_fstypename);
+#endif
+
+    return g_mounts.count;
+}
+
+// Copies the source of the nullfs mount at path; 0 if there is none
+static int mount_source(const char* path, char* from, size_t size) {
+    int found = 0;
+    pthread_mutex_lock(&g_mounts.lock);
+    if (g_mounts.buckets) {
+        mount_entry_t* e = *mount_slot(path);
+        if (e && !strcmp(e->fstype, "nullfs")) {
+            if (from) snprintf(from, size, "%s", e->from ? e->from : "");
+            found = 1;
+        }
+    }
+    pthread_mutex_unlock(&g_mounts.lock);
+    return found;
+}
+
+// f_mntfromname is MNAMELEN bytes, so a long source may come back truncated
+static int mount_source_matches(const char* from, const char* path) {
+    size_t n = strlen(from);
+    if (!strcmp(from, path)) return 1;
+    return n >= sizeof(((struct statfs*)0)->f_mntfromname) - 1 && !strncmp(from, path, n);
+}
+
+static int mount_nullfs(const char* src, const char* dst) {
+    struct iovec iov[] = {
+        IOVEC_ENTRY("fstype"), IOVEC_ENTRY("nullfs"),
+        IOVEC_ENTRY("from"),   IOVEC_ENTRY(src),
+        IOVEC_ENTRY("fspath"), IOVEC_ENTRY(dst),
+    };
+    double t = trace_begin();
+    int rc = nmount(iov, IOVEC_SIZE(iov), 0);
+    const char* from = trace_path(src);
+    trace_end(TR_MOUNT, dst, from, strlen(from), TRACE_RESULT(rc), 0, 0, t);
+    if (rc == 0)
+        mount_table_set(dst, src, "nullfs");
+    return rc;
+}
+
+static int unmount_path(const char* path, int flags) {
+    double t = trace_begin();
+    int rc = unmount(path, flags);
+    trace_end(TR_UNMOUNT, path, NULL, 0, TRACE_RESULT(rc), 0, (flags & MNT_FORCE) ? 1 : 0, t);
+    if (rc == 0)
+        mount_table_del(path);
+    return rc;
+}
+
+static int is_mounted(const char* path) {
+    return mount_source(path, NULL, 0);
+}
+
+// Asks the kernel rather than the snapshot; confirms that unmounts landed
+static int is_mounted_live(const char* path) {
+    struct statfs sfs;
+    double t = trace_begin();
+    int rc = statfs(path, &sfs);
+    trace_end(TR_STATFS, path, NULL, 0, TRACE_RESULT(rc), 0, 0, t);
+    if (rc != 0)
+        return 0;
+    return strcmp(sfs.f_fstypename, "nullfs") == 0;
+}
+
+// ---------------- SAFE RECURSIVE DELETE ----------------
+// Trees are removed relative to directory fds (openat/fdopendir/unlinkat), so
+// no absolute path is re-resolved per entry and a symlink is unlinked, never
+// followed. d_type saves the stat for directories; other entries are
+// fstatat'd relative to their parent to count the bytes freed.
+typedef struct {
+    long long bytes;
+    long long inodes;
+} delete_stats_t;
+
+static int remove_tree_at(int parent_fd, const char* name, delete_stats_t* stats) {
+    int fd = openat(parent_fd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    DIR* d = fdopendir(fd);
+    if (!d) {
+        close(fd);
+        return -1;
+    }
+
+    struct dirent* e;
+    struct stat st;
+    int result = 0;
+
+    while ((e = readdir(d))) {
+        if (!strcmp(e->d_name, ".") || !strcmp(e->d_name, ".."))
+            continue;
+
+        int is_dir = (e->d_type == DT_DIR);
+        st.st_size = 0;
+        if (!is_dir && (stats || e->d_type == DT_UNKNOWN)) {
+            if (fstatat(fd, e->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                result = -1;
+                continue;
+            }
+            is_dir = S_ISDIR(st.st_mode);
+        }
+
+        if (is_dir) {
+            if (remove_tree_at(fd, e->d_name, stats) != 0)
+                result = -1;
+        } else if (unlinkat(fd, e->d_name, 0) != 0) {
+            result = -1;
+        } else if (stats) {
+            stats->bytes += st.st_size;
+            stats->inodes++;
+        }
+    }
+
+    closedir(d);
+
+    // Finally remove the directory itself
+    if (unlinkat(parent_fd, name, AT_REMOVEDIR) != 0)
+        return -1;
+    if (stats) stats->inodes++;
+    return result;
+}
+
+static int rmdir_recursive(const dir_t* parent, const char* name) {
+    double t = trace_begin();
+    int rc = remove_tree_at(parent->fd, name, NULL);
+    trace_end_at(TR_DELETE, parent, name, NULL, 0, TRACE_RESULT(rc), 0, 0, t);
+    return rc;
+}
+
+// Background deleter: a tree is renamed into TRASH_DIR (atomic, so the name
+// is free again at once, e.g. for a title being reinstalled) and removed by
+// one worker thread while the scan goes on. Trees left in TRASH_DIR by an
+// interrupted run are picked up by deleter_start(). Jobs are names in the
+// held trash folder.
+#define TRASH_DIR GM_ROOT "/user/.gm_trash"
+
+static dir_t g_trash = { -1, TRASH_DIR };
+
+typedef struct delete_job {
+    struct delete_job* next;
+    char* name;
+} delete_job_t;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t idle;
+    delete_job_t* head;
+    delete_job_t* tail;
+    int busy;
+    int started;
+    unsigned seq;
+    delete_stats_t stats;
+} g_deleter = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER,
+                PTHREAD_COND_INITIALIZER, NULL, NULL, 0, 0, 0, { 0, 0 } };
+
+static void* deleter_main(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_deleter.lock);
+    for (;;) {
+        while (!g_deleter.head)
+            pthread_cond_wait(&g_deleter.wake, &g_deleter.lock);
+
+        delete_job_t* job = g_deleter.head;
+        g_deleter.head = job->next;
+        if (!g_deleter.head) g_deleter.tail = NULL;
+        g_deleter.busy = 1;
+        pthread_mutex_unlock(&g_deleter.lock);
+
+        delete_stats_t stats = {};
+        remove_tree_at(g_trash.fd, job->name, &stats);
+        free(job->name);
+        free(job);
+
+        pthread_mutex_lock(&g_deleter.lock);
+        g_deleter.stats.bytes += stats.bytes;
+        g_deleter.stats.inodes += stats.inodes;
+        g_deleter.busy = 0;
+        if (!g_deleter.head)
+            pthread_cond_broadcast(&g_deleter.idle);
+    }
+    return NULL;
+}
+
+static void deleter_push(const char* name) {
+    delete_job_t* job = (delete_job_t*)malloc(sizeof(delete_job_t));
+    char* copy = strdup(name);
+    if (!job || !copy) {
+        free(job);
+        free(copy);
+        rmdir_recursive(&g_trash, name);
+        return;
+    }
+    job->next = NULL;
+    job->name = copy;
+
+    pthread_mutex_lock(&g_deleter.lock);
+    if (g_deleter.tail) g_deleter.tail->next = job;
+    else g_deleter.head = job;
+    g_deleter.tail = job;
+    pthread_cond_signal(&g_deleter.wake);
+    pthread_mutex_unlock(&g_deleter.lock);
+}
+
+// Starts the worker and queues anything an earlier run left in the trash
+static void deleter_start(void) {
+    if (g_deleter.started) return;
+
+    mkdir(TRASH_DIR, 0755);
+    if (dir_open(&g_trash, NULL, TRASH_DIR) != 0) return;
+
+    pthread_mutex_lock(&g_deleter.lock);
+    pthread_t t;
+    if (pthread_create(&t, NULL, deleter_main, NULL) == 0) {
+        pthread_detach(t);
+        g_deleter.started = 1;
+    }
+    pthread_mutex_unlock(&g_deleter.lock);
+    if (!g_deleter.started) return;
+
+    DIR* d = dir_list(&g_trash);
+    if (!d) return;
+    struct dirent* e;
+    while ((e = readdir(d))) {
+        if (!strcmp(e->d_name, ".") || !strcmp(e->d_name, ".."))
+            continue;
+        deleter_push(e->d_name);
+    }
+    closedir(d);
+}
+
+// Removes parent/name in the background; falls back to deleting it here when
+// it can't be moved into the trash (or no worker is running)
+static void delete_tree_async(const dir_t* parent, const char* name) {
+    char trash[NAME_MAX + 1];
+
+    pthread_mutex_lock(&g_deleter.lock);
+    int started = g_deleter.started;
+    unsigned seq = g_deleter.seq++;
+    pthread_mutex_unlock(&g_deleter.lock);
+
+    snprintf(trash, sizeof(trash), "%s.%d.%u", name, (int)getpid(), seq);
+
+    // errno only means something right after the rename; without the
+    // deleter thread the tree is removed here
+    if (started) {
+        if (tr_renameat(parent, name, &g_trash, trash) == 0) {
+            deleter_push(trash);
+            return;
+        }
+        if (errno == ENOENT)
+            return;
+    }
+
+    delete_stats_t stats = {};
+    remove_tree_at(parent->fd, name, &stats);
+    pthread_mutex_lock(&g_deleter.lock);
+    g_deleter.stats.bytes += stats.bytes;
+    g_deleter.stats.inodes += stats.inodes;
+    pthread_mutex_unlock(&g_deleter.lock);
+}
+
+// Waits for the queue to empty and returns what has been freed so far
+static delete_stats_t deleter_drain(void) {
+    pthread_mutex_lock(&g_deleter.lock);
+    while (g_deleter.head || g_deleter.busy)
+        pthread_cond_wait(&g_deleter.idle, &g_deleter.lock);
+    delete_stats_t stats = g_deleter.stats;
+    pthread_mutex_unlock(&g_deleter.lock);
+    return stats;
+}
+
+// ---------------- COPY ENGINE ----------------
+// Used by the metadata installer. Uses copy_file_range() where the kernel has
+// it, otherwise a read/write loop through one aligned buffer per thread that
+// is sized to the file (param files are a few KB) and reused across files.
+// One read can feed several destinations. Short writes are retried and the
+// source mtime is carried over to the copy.
+#define COPY_BUF_ALIGN 4096
+#define COPY_BUF_MAX   (2 * 1024 * 1024)
+#define COPY_MAX_DSTS  2
+
+#if defined(__linux__) || (defined(__FreeBSD_version) && __FreeBSD_version >= 1300037)
+#define HAVE_COPY_FILE_RANGE 1
+#endif
+
+static __thread char* copy_buf = NULL;
+static __thread size_t copy_buf_size = 0;
+
+static char* copy_buffer_get(size_t want) {
+    if (want > COPY_BUF_MAX) want = COPY_BUF_MAX;
+    want = (want + COPY_BUF_ALIGN - 1) & ~(size_t)(COPY_BUF_ALIGN - 1);
+    if (want == 0) want = COPY_BUF_ALIGN;
+
+    if (copy_buf && copy_buf_size >= want)
+        return copy_buf;
+
+    void* p = NULL;
+    if (posix_memalign(&p, COPY_BUF_ALIGN, want) != 0)
+        return copy_buf;  // keep using the smaller buffer if we have one
+
+    free(copy_buf);
+    copy_buf = (char*)p;
+    copy_buf_size = want;
+    return copy_buf;
+}
+
+// Called by each worker thread before it exits
+static void copy_buffer_release(void) {
+    free(copy_buf);
+    copy_buf = NULL;
+    copy_buf_size = 0;
+}
+
+static int write_all(int fd, const char* buf, size_t len) {
+    while (len > 0) {
+        ssize_t w = write(fd, buf, len);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (w == 0) {
+            errno = EIO;
+            return -1;
+        }
+        buf += w;
+        len -= w;
+    }
+    return 0;
+}
+
+// Copies src/name to name in every folder of dsts (replacing it) while reading
+// the source only once. ok[i] is set for each destination that received the
+// whole file. Returns the number of source bytes copied, or -1 if the source
+// failed.
+static long long copy_file_multi(const dir_t* src, const char* name, const dir_t* const* dsts, int ndst,
+                                 const struct stat* src_st, int* ok) {
+    int src_fd = openat(src->fd, name, O_RDONLY | O_CLOEXEC);
+    if (src_fd < 0) return -1;
+
+    int dst_fds[COPY_MAX_DSTS];
+    int open_count = 0;
+    for (int i = 0; i < ndst; i++) {
+        unlinkat(dsts[i]->fd, name, 0);
+        dst_fds[i] = openat(dsts[i]->fd, name, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        ok[i] = (dst_fds[i] >= 0);
+        open_count += ok[i];
+    }
+    if (open_count == 0) {
+        close(src_fd);
+        return -1;
+    }
+
+    long long total = 0;
+    int src_failed = 0;
+
+#ifdef HAVE_COPY_FILE_RANGE
+    // In-kernel copy only helps when there is a single destination
+    for (int i = 0; open_count == 1 && i < ndst; i++) {
+        if (dst_fds[i] < 0) continue;
+        while (total < (long long)src_st->st_size) {
+            ssize_t n = copy_file_range(src_fd, NULL, dst_fds[i], NULL, src_st->st_size - total, 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            total += n;
+        }
+    }
+#endif
+
+    // Buffered path: fan-out, no copy_file_range, or it stopped early (EXDEV, ENOSYS...)
+    if (total < (long long)src_st->st_size || src_st->st_size == 0) {
+        char* buf = copy_buffer_get(src_st->st_size - total);
+        int seek_failed = lseek(src_fd, total, SEEK_SET) < 0;
+        for (int i = 0; i < ndst; i++) {
+            if (dst_fds[i] >= 0 && lseek(dst_fds[i], total, SEEK_SET) < 0)
+                seek_failed = 1;
+        }
+
+        if (!buf || seek_failed) {
+            src_failed = 1;
+        } else {
+            ssize_t n;
+            while (open_count > 0 && (n = read(src_fd, buf, copy_buf_size)) != 0) {
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    src_failed = 1;
+                    break;
+                }
+                for (int i = 0; i < ndst; i++) {
+                    if (dst_fds[i] < 0 || !ok[i]) continue;
+                    if (write_all(dst_fds[i], buf, n) != 0) {
+                        log_at(LOG_WARN, "  Write failed for %s/%s after %lld bytes (errno: %d)\n",
+                               dsts[i]->path, name, total, errno);
+                        ok[i] = 0;
+                        open_count--;
+                    }
+                }
+                total += n;
+            }
+        }
+    }
+
+    struct timespec times[2];
+    times[0] = src_st->st_atim;
+    times[1] = src_st->st_mtim;
+
+    for (int i = 0; i < ndst; i++) {
+        if (dst_fds[i] < 0) continue;
+        if (src_failed) ok[i] = 0;
+        if (ok[i]) futimens(dst_fds[i], times);
+        if (close(dst_fds[i]) != 0) ok[i] = 0;
+    }
+    close(src_fd);
+
+    return src_failed ? -1 : total;
+}
+
+// ---------------- DIFFERENTIAL SYNC ----------------
+// rsync-style: a destination file whose size and mtime match the source (the
+// copy engine carries mtimes over) is left alone, so a remount doesn't rewrite
+// the flash. --sync-hash additionally compares contents when both match.
+// Destination files that no longer exist in the source are pruned.
+typedef struct {
+    int files_copied;
+    int files_unchanged;
+    int files_pruned;
+    long long bytes_copied;
+} sync_stats_t;
+
+static int g_sync_hash = 0;
+
+static int file_hash(const dir_t* dir, const char* name, uint64_t* out) {
+    int fd = openat(dir->fd, name, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    char* buf = copy_buffer_get(COPY_BUF_MAX);
+    if (!buf) {
+        close(fd);
+        return -1;
+    }
+
+    uint64_t h = 14695981039346656037ULL;
+    ssize_t n;
+    while ((n = read(fd, buf, copy_buf_size)) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            close(fd);
+            return -1;
+        }
+        for (ssize_t i = 0; i < n; i++) {
+            h ^= (unsigned char)buf[i];
+            h *= 1099511628211ULL;
+        }
+    }
+    close(fd);
+    *out = h;
+    return 0;
+}
+
+// src/name against the same name in dst
+static int file_needs_sync(const dir_t* src, const char* name, const struct stat* src_st, const dir_t* dst) {
+    struct stat dst_st;
+    if (tr_fstatat(dst, name, &dst_st, 0) != 0 || !S_ISREG(dst_st.st_mode))
+        return 1;
+    if (dst_st.st_size != src_st->st_size || dst_st.st_mtime != src_st->st_mtime)
+        return 1;
+
+    if (g_sync_hash) {
+        uint64_t hs, hd;
+        if (file_hash(src, name, &hs) != 0 || file_hash(dst, name, &hd) != 0)
+            return 1;
+        return hs != hd;
+    }
+    return 0;
+}
+
+// Removes entries of dst that have no counterpart in src. keep() limits
+// pruning to the names this sync manages (NULL: everything).
+static void prune_dir(const dir_t* src, const dir_t* dst, int (*keep)(const char*), sync_stats_t* stats) {
+    DIR* d = dir_list(dst);
+    if (!d) return;
+
+    struct dirent* e;
+    struct stat st;
+
+    while ((e = readdir(d))) {
+        if (!strcmp(e->d_name, ".") || !strcmp(e->d_name, "..")) continue;
+        if (keep && !keep(e->d_name)) continue;
+
+        if (tr_fstatat(src, e->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0) continue;
+        if (tr_fstatat(dst, e->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) continue;
+
+        if (S_ISDIR(st.st_mode) ? rmdir_recursive(dst, e->d_name) == 0 : tr_unlinkat(dst, e->d_name) == 0)
+            stats->files_pruned++;
+    }
+    closedir(d);
+}
+
+// ---------------- METADATA INSTALLER ----------------
+static int is_appmeta_file(const char* name) {
+    if (!strcasecmp(name, "param.json") ||
+        !strcasecmp(name, "param.sfo"))
+        return 1;
+
+    const char* ext = strrchr(name, '.');
+    if (!ext) return 0;
+
+    return !strcasecmp(ext, ".png") ||
+           !strcasecmp(ext, ".dds") ||
+           !strcasecmp(ext, ".at9");
+}
+
+// Walks one source directory. Every file goes to dst; when meta_dst is set
+// (top level of sce_sys) files accepted by is_appmeta_file() also go there,
+// and a file both destinations need is read from the source only once.
+static int sync_tree(const dir_t* src, const dir_t* dst, const dir_t* meta_dst,
+                     sync_stats_t* app, sync_stats_t* meta) {
+    DIR* d = dir_list(src);
+    if (!d) return -1;
+
+    struct dirent* e;
+    struct stat st;
+
+    while ((e = readdir(d))) {
+        const char* name = e->d_name;
+        if (!strcmp(name, ".") || !strcmp(name, "..")) continue;
+
+        if (tr_fstatat(src, name, &st, 0) != 0) continue;
+
+        if (S_ISDIR(st.st_mode)) {
+            dir_t sub_src = { -1 }, sub_dst = { -1 };
+            if (tr_mkdirat(dst, name, 0755) && errno != EEXIST) {
+                log_at(LOG_WARN, "mkdir failed for %s/%s (errno: %d)\n", dst->path, name, errno);
+                continue;
+            }
+            if (dir_open(&sub_src, src, name) == 0 && dir_open(&sub_dst, dst, name) == 0)
+                sync_tree(&sub_src, &sub_dst, NULL, app, meta);
+            dir_close(&sub_src);
+            dir_close(&sub_dst);
+            continue;
+        }
+
+        const dir_t* dsts[COPY_MAX_DSTS];
+        sync_stats_t* stats[COPY_MAX_DSTS];
+        int ndst = 0;
+
+        if (file_needs_sync(src, name, &st, dst)) {
+            dsts[ndst] = dst;
+            stats[ndst++] = app;
+        } else {
+            app->files_unchanged++;
+        }
+
+        if (meta_dst && S_ISREG(st.st_mode) && is_appmeta_file(name)) {
+            if (file_needs_sync(src, name, &st, meta_dst)) {
+                dsts[ndst] = meta_dst;
+                stats[ndst++] = meta;
+            } else {
+                meta->files_unchanged++;
+            }
+        }
+
+        if (ndst == 0) continue;
+
+        int ok[COPY_MAX_DSTS] = {};
+        double t = trace_begin();
+        long long n = copy_file_multi(src, name, dsts, ndst, &st, ok);
+        if (g_trace.active) {
+            char first[PATH_MAX];
+            size_t first_len =
+                path_join(first, sizeof(first), trace_path(dsts[0]->path), name) == 0 ? strlen(first) : 0;
+            trace_end_at(TR_COPY, src, name, first, first_len, n < 0 ? -errno : ndst, n < 0 ? 0 : n, 0, t);
+        }
+        for (int i = 0; i < ndst; i++) {
+            if (n < 0 || !ok[i]) {
+                log_at(LOG_WARN, "  Copy failed for %s/%s (errno: %d)\n", dsts[i]->path, name, errno);
+                continue;
+            }
+            stats[i]->files_copied++;
+            stats[i]->bytes_copied += n;
+        }
+    }
+    closedir(d);
+
+    prune_dir(src, dst, NULL, app);
+    return 0;
+}
+
+// Installs sce_sys into /user/app/<TITLE>/sce_sys and /user/appmeta/<TITLE>;
+// user_app is the held /user/app/<TITLE>
+static int install_metadata(const dir_t* src_sce_sys, const dir_t* user_app, const char* title_id,
+                            sync_stats_t* app, sync_stats_t* meta) {
+    dir_t user_sce_sys = { -1 }, appmeta = { -1 };
+
+    if (tr_mkdirat(user_app, "sce_sys", 0755) && errno != EEXIST) {
+        log_at(LOG_WARN, "mkdir failed for %s/sce_sys (errno: %d)\n", user_app->path, errno);
+        return -1;
+    }
+    tr_mkdirat(&g_user_appmeta, title_id, 0755);
+
+    int rc = -1;
+    if (dir_open(&user_sce_sys, user_app, "sce_sys") == 0 &&
+        dir_open(&appmeta, &g_user_appmeta, title_id) == 0) {
+        rc = sync_tree(src_sce_sys, &user_sce_sys, &appmeta, app, meta);
+
+        // Only metadata files are ours to prune; anything else the system keeps
+        prune_dir(src_sce_sys, &appmeta, is_appmeta_file, meta);
+    }
+    dir_close(&user_sce_sys);
+    dir_close(&appmeta);
+    return rc;
+}
+
+// ---------------- Get Icon Sound ----------------
+// NOTE: sqlite3 not available in SDK, sound info update disabled
+static int update_snd0info(const char* title_id) {
+    (void)title_id;  // Unused parameter
+    log_at(LOG_DEBUG, "[snd0] Sound info update skipped (sqlite3 not available)\n");
+    return 0;
+}
+
+// ---------------- JSON TOKENIZER ----------------
+// Zero-allocation, bounds-checked reader for param.json. Values are returned
+// as spans into the caller's buffer and looked up by dotted path, e.g.
+// "localizedParameters.en-US.titleName" (a numeric segment indexes an array).
+// Structural characters are located 16 bytes at a time with SSE2 or NEON,
+// with a table-driven scalar loop for the tail and other targets.
+typedef enum {
+    JSON_NONE = 0,
+    JSON_OBJECT,
+    JSON_ARRAY,
+    JSON_STRING,
+    JSON_PRIMITIVE,
+} json_type_t;
+
+typedef struct {
+    json_type_t type;
+    const char* start;   // strings: between the quotes (still escaped)
+    size_t len;          // objects/arrays: including the brackets
+} json_value_t;
+
+typedef struct {
+    const char* p;
+    const char* end;
+} json_iter_t;
+
+// Scan classes: JSON_SCAN_STRUCT ends a primitive or separates members,
+// JSON_SCAN_STRING matters inside a string, JSON_SCAN_NEST is all a
+// container skip needs to track depth.
+#define JSON_SCAN_STRUCT 1
+#define JSON_SCAN_STRING 2
+#define JSON_SCAN_NEST   4
+
+static unsigned char json_char_class[256];
+
+static void json_init_tables(void) {
+    const char* nest = "\"{}[]";
+    for (const char* c = nest; *c; c++)
+        json_char_class[(unsigned char)*c] |= JSON_SCAN_NEST | JSON_SCAN_STRUCT;
+    json_char_class[(unsigned char)','] |= JSON_SCAN_STRUCT;
+    json_char_class[(unsigned char)':'] |= JSON_SCAN_STRUCT;
+    json_char_class[(unsigned char)'"'] |= JSON_SCAN_STRING;
+    json_char_class[(unsigned char)'\\'] |= JSON_SCAN_STRING;
+}
+
+static pthread_once_t json_tables_once = PTHREAD_ONCE_INIT;
+
+// Bitmask (bit i = p[i]) of the bytes in the 16-byte block at p that are '"'
+// or whose class matches mask; json_block_mask(p, 0) is just the quotes.
+// Only called when at least 16 bytes remain.
+static inline uint32_t json_block_mask(const char* p, int mask) {
+#if defined(__SSE2__)
+    __m128i v = _mm_loadu_si128((const __m128i*)p);
+    __m128i m = _mm_cmpeq_epi8(v, _mm_set1_epi8('"'));
+    if (mask & JSON_SCAN_STRING) {
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+    }
+    if (mask & (JSON_SCAN_NEST | JSON_SCAN_STRUCT)) {
+        __m128i vl = _mm_or_si128(v, _mm_set1_epi8(0x20));   // '[' | 0x20 == '{'
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(vl, _mm_set1_epi8('{')));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(vl, _mm_set1_epi8('}')));
+    }
+    if (mask & JSON_SCAN_STRUCT) {
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8(',')));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8(':')));
+    }
+    return (uint32_t)_mm_movemask_epi8(m);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    uint8x16_t v = vld1q_u8((const uint8_t*)p);
+    uint8x16_t m = vceqq_u8(v, vdupq_n_u8('"'));
+    if (mask & JSON_SCAN_STRING) {
+        m = vorrq_u8(m, vceqq_u8(v, vdupq_n_u8('\\')));
+    }
+    if (mask & (JSON_SCAN_NEST | JSON_SCAN_STRUCT)) {
+        uint8x16_t vl = vorrq_u8(v, vdupq_n_u8(0x20));
+        m = vorrq_u8(m, vceqq_u8(vl, vdupq_n_u8('{')));
+        m = vorrq_u8(m, vceqq_u8(vl, vdupq_n_u8('}')));
+    }
+    if (mask & JSON_SCAN_STRUCT) {
+        m = vorrq_u8(m, vceqq_u8(v, vdupq_n_u8(',')));
+        m = vorrq_u8(m, vceqq_u8(v, vdupq_n_u8(':')));
+    }
+    // NEON has no movemask: weight each lane by its bit and add per half
+    static const uint8_t weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    uint8x16_t t = vandq_u8(m, vld1q_u8(weights));
+    return (uint32_t)vaddv_u8(vget_low_u8(t)) | ((uint32_t)vaddv_u8(vget_high_u8(t)) << 8);
+#else
+    uint32_t bits = 0;
+    for (int i = 0; i < 16; i++) {
+        if (p[i] == '"' || (json_char_class[(unsigned char)p[i]] & mask))
+            bits |= 1u << i;
+    }
+    return bits;
+#endif
+}
+
+// Next byte in [p, end) whose class matches mask
+static const char* json_scan(const char* p, const char* end, int mask) {
+    while (end - p >= 16) {
+        uint32_t bits = json_block_mask(p, mask);
+        if (bits)
+            return p + __builtin_ctz(bits);
+        p += 16;
+    }
+    while (p < end && !(json_char_class[(unsigned char)*p] & mask))
+        p++;
+    return p;
+}
+
+// p is at '{' or '['; returns the matching close bracket or NULL. Whole blocks
+// are consumed from one bitmask of quotes and brackets; blocks containing a
+// backslash (rare in param.json) take the byte-wise path for escapes.
+static const char* json_skip_container(const char* p, const char* end) {
+    int depth = 0;
+    int in_string = 0;
+    int escaped = 0;
+
+    while (p < end) {
+        if (end - p >= 16 && !escaped) {
+            uint32_t slash = json_block_mask(p, JSON_SCAN_STRING) & ~json_block_mask(p, 0);
+            if (!slash) {
+                uint32_t bits = json_block_mask(p, JSON_SCAN_NEST);
+                while (bits) {
+                    int i = __builtin_ctz(bits);
+                    bits &= bits - 1;
+                    char c = p[i];
+                    if (c == '"') {
+                        in_string = !in_string;
+                    } else if (!in_string) {
+                        if (c == '{' || c == '[') {
+                            depth++;
+                        } else if (--depth == 0) {
+                            return p + i;
+                        }
+                    }
+                }
+                p += 16;
+                continue;
+            }
+        }
+
+        // Byte-wise until the end of this block
+        const char* stop = (end - p >= 16) ? p + 16 : end;
+        for (; p < stop; p++) {
+            char c = *p;
+            if (escaped) {
+                escaped = 0;
+            } else if (in_string) {
+                if (c == '\\') escaped = 1;
+                else if (c == '"') in_string = 0;
+            } else if (c == '"') {
+                in_string = 1;
+            } else if (c == '{' || c == '[') {
+                depth++;
+            } else if (c == '}' || c == ']') {
+                if (--depth == 0) return p;
+            }
+        }
+    }
+    return NULL;
+}
+
+static const char* json_skip_ws(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+        p++;
+    return p;
+}
+
+// Returns a pointer to the closing quote of the string whose body starts at p
+static const char* json_string_end(const char* p, const char* end) {
+    for (;;) {
+        p = json_scan(p, end, JSON_SCAN_STRING);
+        if (p >= end) return NULL;
+        if (*p == '"') return p;
+        p += 2;  // skip the escaped character
+        if (p > end) return NULL;
+    }
+}
+
+// Parses the value at p into v; returns the position after it or NULL
+static const char* json_parse_value(const char* p, const char* end, json_value_t* v) {
+    p = json_skip_ws(p, end);
+    if (p >= end) return NULL;
+
+    if (*p == '"') {
+        const char* q = json_string_end(p + 1, end);
+        if (!q) return NULL;
+        v->type = JSON_STRING;
+        v->start = p + 1;
+        v->len = q - (p + 1);
+        return q + 1;
+    }
+
+    if (*p == '{' || *p == '[') {
+        const char* s = p;
+        p = json_skip_container(p, end);
+        if (!p) return NULL;
+        v->type = (*s == '{') ? JSON_OBJECT : JSON_ARRAY;
+        v->start = s;
+        v->len = p + 1 - s;
+        return p + 1;
+    }
+
+    // number, true, false, null
+    const char* s = p;
+    p = json_scan(p, end, JSON_SCAN_STRUCT);
+    const char* e = p;
+    while (e > s && (e[-1] == ' ' || e[-1] == '\t' || e[-1] == '\n' || e[-1] == '\r'))
+        e--;
+    if (e == s) return NULL;
+    v->type = JSON_PRIMITIVE;
+    v->start = s;
+    v->len = e - s;
+    return p;
+}
+
+static int json_iter_begin(const json_value_t* v, json_iter_t* it) {
+    if (v->type != JSON_OBJECT && v->type != JSON_ARRAY) return -1;
+    it->p = v->start + 1;
+    it->end = v->start + v->len - 1;
+    return 0;
+}
+
+// Next member of an object; key is a JSON_STRING span
+static int json_object_next(json_iter_t* it, json_value_t* key, json_value_t* val) {
+    const char* p = json_skip_ws(it->p, it->end);
+    if (p < it->end && *p == ',') p = json_skip_ws(p + 1, it->end);
+    if (p >= it->end || *p != '"') return 0;
+
+    p = json_parse_value(p, it->end, key);
+    if (!p) return 0;
+    p = json_skip_ws(p, it->end);
+    if (p >= it->end || *p != ':') return 0;
+
+    p = json_parse_value(p + 1, it->end, val);
+    if (!p) return 0;
+    it->p = p;
+    return 1;
+}
+
+static int json_array_next(json_iter_t* it, json_value_t* val) {
+    const char* p = json_skip_ws(it->p, it->end);
+    if (p < it->end && *p == ',') p = json_skip_ws(p + 1, it->end);
+    if (p >= it->end) return 0;
+
+    p = json_parse_value(p, it->end, val);
+    if (!p) return 0;
+    it->p = p;
+    return 1;
+}
+
+// Looks up a dotted path below root
+static int json_query_value(const json_value_t* root, const char* path, json_value_t* out) {
+    json_value_t cur = *root;
+
+    while (*path) {
+        const char* seg_end = strchr(path, '.');
+        size_t seg_len = seg_end ? (size_t)(seg_end - path) : strlen(path);
+        json_iter_t it;
+        json_value_t key, val;
+        int found = 0;
+
+        if (json_iter_begin(&cur, &it) != 0) return -1;
+
+        if (cur.type == JSON_OBJECT) {
+            while (json_object_next(&it, &key, &val)) {
+                if (key.len == seg_len && !memcmp(key.start, path, seg_len)) {
+                    found = 1;
+                    break;
+                }
+            }
+        } else {
+            char* idx_end;
+            long idx = strtol(path, &idx_end, 10);
+            if (idx_end != path + seg_len || idx < 0) return -1;
+            while (json_array_next(&it, &val)) {
+                if (idx-- == 0) {
+                    found = 1;
+                    break;
+                }
+            }
+        }
+
+        if (!found) return -1;
+        cur = val;
+        path += seg_len;
+        if (*path == '.') path++;
+    }
+
+    *out = cur;
+    return 0;
+}
+
+// The document's top-level value. For the usual "{...}" document the span is
+// taken from the first and last non-blank bytes instead of scanning it all.
+static int json_root(const char* json, size_t len, json_value_t* root) {
+    pthread_once(&json_tables_once, json_init_tables);
+
+    const char* end = json + len;
+    const char* p = json_skip_ws(json, end);
+    while (end > p && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\n' ||
+                       end[-1] == '\r' || end[-1] == '\0'))
+        end--;
+    if (p >= end) return -1;
+
+    if ((*p == '{' && end[-1] == '}') || (*p == '[' && end[-1] == ']')) {
+        root->type = (*p == '{') ? JSON_OBJECT : JSON_ARRAY;
+        root->start = p;
+        root->len = end - p;
+        return 0;
+    }
+    return json_parse_value(p, end, root) ? 0 : -1;
+}
+
+static int json_query(const char* json, size_t len, const char* path, json_value_t* out) {
+    json_value_t root;
+    if (json_root(json, len, &root) != 0) return -1;
+    return json_query_value(&root, path, out);
+}
+
+// Copies a string value into out, decoding escapes. \uXXXX is emitted as UTF-8.
+static int json_string_copy(const json_value_t* v, char* out, size_t size) {
+    if (v->type != JSON_STRING || size == 0) return -1;
+
+    const char* p = v->start;
+    const char* end = v->start + v->len;
+    size_t i = 0;
+
+    while (p < end && i < size - 1) {
+        char c = *p++;
+        if (c != '\\' || p >= end) {
+            out[i++] = c;
+            continue;
+        }
+        c = *p++;
+        switch (c) {
+            case 'n': out[i++] = '\n'; break;
+            case 't': out[i++] = '\t'; break;
+            case 'r': out[i++] = '\r'; break;
+            case 'b': out[i++] = '\b'; break;
+            case 'f': out[i++] = '\f'; break;
+            case 'u': {
+                unsigned cp = 0;
+                int k = 0;
+                for (; k < 4 && p < end && isxdigit((unsigned char)*p); k++, p++)
+                    cp = cp * 16 + (isdigit((unsigned char)*p) ? *p - '0' : (tolower(*p) - 'a' + 10));
+                if (cp < 0x80) {
+                    out[i++] = (char)cp;
+                } else if (cp < 0x800 && i + 2 < size) {
+                    out[i++] = (char)(0xC0 | (cp >> 6));
+                    out[i++] = (char)(0x80 | (cp & 0x3F));
+                } else if (i + 3 < size) {
+                    out[i++] = (char)(0xE0 | (cp >> 12));
+                    out[i++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                    out[i++] = (char)(0x80 | (cp & 0x3F));
+                }
+                break;
+            }
+            default: out[i++] = c; break;
+        }
+    }
+    out[i] = '\0';
+    return 0;
+}
+
+static int json_get_string(const char* json, size_t len, const char* path, char* out, size_t size) {
+    json_value_t v;
+    if (json_query(json, len, path, &v) != 0) return -1;
+    return json_string_copy(&v, out, size);
+}
+
+// ---------------- SFO READER FOR PS4 ----------------
+// param.sfo is read with one call and parsed into a table of (key, format,
+// value) spans pointing into that buffer. Every header, key and data offset
+// is checked against the file size before it is used.
+//
+//   header (20 bytes) | entry[count] (16 bytes each) | key table | data table
+#define SFO_MAGIC        0x46535000  // "\0PSF"
+#define SFO_HEADER_SIZE  20
+#define SFO_ENTRY_SIZE   16
+#define SFO_MAX_SIZE     (64 * 1024)
+#define SFO_MAX_PARAMS   128
+
+#define SFO_FMT_UTF8_RAW 0x0004
+#define SFO_FMT_UTF8     0x0204
+#define SFO_FMT_INT32    0x0404
+
+typedef struct {
+    const char* key;
+    uint16_t fmt;
+    const uint8_t* data;
+    uint32_t len;
+} sfo_param_t;
+
+typedef struct {
+    uint8_t* buf;
+    size_t size;
+    sfo_param_t params[SFO_MAX_PARAMS];
+    int count;
+    int sorted;                 // keys in strcmp order, lookups can bisect
+} sfo_t;
+
+// Reads a whole (small) file with one read; returns a NUL-terminated buffer.
+// name is relative to dir, or a full path when dir is NULL.
+static char* read_small_file(const dir_t* dir, const char* name, size_t max_len, size_t* len_out) {
+    double t = trace_begin();
+    int fd = openat(dir ? dir->fd : AT_FDCWD, name, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        trace_end_at(TR_READ, dir, name, NULL, 0, -errno, 0, 0, t);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 || (size_t)st.st_size > max_len) {
+        close(fd);
+        return NULL;
+    }
+
+    char* buf = (char*)malloc(st.st_size + 1);
+    if (!buf) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t len = 0;
+    while (len < (size_t)st.st_size) {
+        ssize_t n = read(fd, buf + len, st.st_size - len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        len += n;
+    }
+    close(fd);
+
+    buf[len] = '\0';
+    *len_out = len;
+    trace_end_at(TR_READ, dir, name, buf, len, 0, len, 0, t);
+    return buf;
+}
+
+// Maps a whole file read-only; the mapping is not NUL-terminated
+static char* map_small_file(const dir_t* dir, const char* name, size_t max_len, size_t* len_out) {
+    double t = trace_begin();
+    int fd = openat(dir ? dir->fd : AT_FDCWD, name, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        trace_end_at(TR_READ, dir, name, NULL, 0, -errno, 0, 0, t);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 || (size_t)st.st_size > max_len) {
+        close(fd);
+        return NULL;
+    }
+
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+
+    *len_out = st.st_size;
+    trace_end_at(TR_READ, dir, name, (const char*)map, st.st_size, 0, st.st_size, 0, t);
+    return (char*)map;
+}
+
+static uint32_t sfo_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t sfo_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+// Builds the table over buf; entries with out-of-range offsets are dropped
+static int sfo_parse(sfo_t* s) {
+    const uint8_t* b = s->buf;
+    size_t size = s->size;
+
+    if (size < SFO_HEADER_SIZE || sfo_u32(b) != SFO_MAGIC)
+        return -1;
+
+    uint32_t key_off = sfo_u32(b + 8);
+    uint32_t data_off = sfo_u32(b + 12);
+    uint32_t count = sfo_u32(b + 16);
+
+    if (count > SFO_MAX_PARAMS ||
+        SFO_HEADER_SIZE + (uint64_t)count * SFO_ENTRY_SIZE > key_off ||
+        key_off > size || data_off > size)
+        return -1;
+
+    s->count = 0;
+    s->sorted = 1;
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t* e = b + SFO_HEADER_SIZE + i * SFO_ENTRY_SIZE;
+        uint64_t kpos = (uint64_t)key_off + sfo_u16(e);
+        uint32_t len = sfo_u32(e + 4);
+        uint32_t max_len = sfo_u32(e + 8);
+        uint64_t dpos = (uint64_t)data_off + sfo_u32(e + 12);
+
+        if (kpos >= size || len > max_len || dpos + max_len > size)
+            continue;
+        const char* key = (const char*)b + kpos;
+        if (!memchr(key, '\0', size - kpos))
+            continue;
+
+        sfo_param_t* p = &s->params[s->count];
+        p->key = key;
+        p->fmt = sfo_u16(e + 2);
+        p->data = b + dpos;
+        p->len = len;
+        if (s->count > 0 && strcmp(s->params[s->count - 1].key, key) >= 0)
+            s->sorted = 0;
+        s->count++;
+    }
+    return 0;
+}
+
+static void sfo_free(sfo_t* s) {
+    free(s->buf);
+    s->buf = NULL;
+    s->size = 0;
+    s->count = 0;
+}
+
+static int sfo_load(const dir_t* dir, const char* name, sfo_t* s) {
+    size_t len = 0;
+
+    memset(s, 0, sizeof(*s));
+    s->buf = (uint8_t*)read_small_file(dir, name, SFO_MAX_SIZE, &len);
+    if (!s->buf)
+        return -1;
+    s->size = len;
+
+    if (sfo_parse(s) != 0) {
+        sfo_free(s);
+        return -1;
+    }
+    return 0;
+}
+
+static const sfo_param_t* sfo_find(const sfo_t* s, const char* key) {
+    if (s->sorted) {
+        int lo = 0, hi = s->count - 1;
+        while (lo <= hi) {
+            int mid = (lo + hi) / 2;
+            int c = strcmp(s->params[mid].key, key);
+            if (c == 0) return &s->params[mid];
+            if (c < 0) lo = mid + 1;
+            else hi = mid - 1;
+        }
+        return NULL;
+    }
+
+    for (int i = 0; i < s->count; i++)
+        if (!strcmp(s->params[i].key, key))
+            return &s->params[i];
+    return NULL;
+}
+
+// Copies a string parameter without its NUL padding or trailing whitespace
+static int sfo_get_string(const sfo_t* s, const char* key, char* out, size_t size) {
+    const sfo_param_t* p = sfo_find(s, key);
+    if (!p || p->fmt == SFO_FMT_INT32 || size == 0)
+        return -1;
+
+    size_t n = strnlen((const char*)p->data, p->len);
+    while (n > 0 && isspace(p->data[n - 1]))
+        n--;
+    if (n >= size)
+        n = size - 1;
+
+    memcpy(out, p->data, n);
+    out[n] = '\0';
+    return 0;
+}
+
+// ---------------- GET GAME REGION ----------------
+static const char* get_game_region(const char* title_id) {
+    if (!title_id || strlen(title_id) < 4) return "Unknown";
+    
+    // PS5 games (PPSA prefix)
+    if (strncmp(title_id, "PPSA", 4) == 0) {
+        char region_code = title_id[4];
+        switch (region_code) {
+            case '0': return "US";
+            case '1': return "EU";
+            case '2': return "JP";
+            case '3': return "Asia";
+            case '4': return "UK";
+            case '5': return "KR";
+            default: return "World";
+        }
+    }
+    
+    // PS4 games (CUSA prefix)
+    if (strncmp(title_id, "CUSA", 4) == 0) {
+        char region_code = title_id[4];
+        switch (region_code) {
+            case '0': return "US";
+            case '1': return "EU";
+            case '2': return "JP";
+            case '3': return "Asia";
+            case '4': return "UK";
+            case '5': return "KR";
+            default: return "World";
+        }
+    }
+    
+    // Other formats
+    if (strncmp(title_id, "NPXS", 4) == 0) return "System";
+    if (strncmp(title_id, "NPWR", 4) == 0) return "World";
+    
+    return "Unknown";
+}
+
+// ---------------- GAME METADATA ----------------
+// param.json (PS5) or param.sfo (PS4) is read once per game into a
+// game_meta_t; the title ID, name and DRM patcher all work from that buffer
+// instead of re-reading the file. Both formats fill the same fields.
+#define META_MAX_LOCALES 32
+
+typedef struct {
+    char lang[16];
+    char title[256];
+} game_locale_name_t;
+
+typedef struct {
+    char* json;                 // mapped param.json, NULL for SFO-only games
+    size_t json_len;
+    sfo_t sfo;                  // param.sfo table, empty unless it was needed
+    char title_id[12];
+    char content_name[256];
+    char content_version[32];
+    char content_id[48];
+    char category[8];           // SFO CATEGORY (gd, gp, ...), empty for PS5
+    char drm_type[32];
+    char default_language[16];
+    game_locale_name_t names[META_MAX_LOCALES];
+    int num_names;
+} game_meta_t;
+
+static int json_key_is(const json_value_t* key, const char* name) {
+    return key->len == strlen(name) && !memcmp(key->start, name, key->len);
+}
+
+// Collects localizedParameters.<lang>.titleName for every language
+static void parse_localized_names(const json_value_t* lp, game_meta_t* m) {
+    json_value_t key, val, title;
+    json_iter_t it;
+
+    if (json_iter_begin(lp, &it) != 0)
+        return;
+
+    while (json_object_next(&it, &key, &val)) {
+        if (json_key_is(&key, "defaultLanguage")) {
+            json_string_copy(&val, m->default_language, sizeof(m->default_language));
+            continue;
+        }
+        if (val.type != JSON_OBJECT || m->num_names >= META_MAX_LOCALES)
+            continue;
+        if (json_query_value(&val, "titleName", &title) != 0)
+            continue;
+
+        game_locale_name_t* n = &m->names[m->num_names];
+        if (json_string_copy(&title, n->title, sizeof(n->title)) != 0)
+            continue;
+        json_string_copy(&key, n->lang, sizeof(n->lang));
+        m->num_names++;
+    }
+}
+
+// Fills the metadata fields in a single walk over the top-level members
+static int game_meta_parse_json(const char* json, size_t len, game_meta_t* m) {
+    json_value_t root, key, val;
+    json_iter_t it;
+    char title_id_alt[12] = {};
+
+    if (json_root(json, len, &root) != 0 || json_iter_begin(&root, &it) != 0)
+        return -1;
+
+    while (json_object_next(&it, &key, &val)) {
+        if (json_key_is(&key, "titleId"))
+            json_string_copy(&val, m->title_id, sizeof(m->title_id));
+        else if (json_key_is(&key, "title_id"))
+            json_string_copy(&val, title_id_alt, sizeof(title_id_alt));
+        else if (json_key_is(&key, "contentName"))
+            json_string_copy(&val, m->content_name, sizeof(m->content_name));
+        else if (json_key_is(&key, "contentVersion"))
+            json_string_copy(&val, m->content_version, sizeof(m->content_version));
+        else if (json_key_is(&key, "contentId"))
+            json_string_copy(&val, m->content_id, sizeof(m->content_id));
+        else if (json_key_is(&key, "applicationDrmType"))
+            json_string_copy(&val, m->drm_type, sizeof(m->drm_type));
+        else if (json_key_is(&key, "localizedParameters"))
+            parse_localized_names(&val, m);
+    }
+
+    if (m->title_id[0] == '\0')
+        snprintf(m->title_id, sizeof(m->title_id), "%s", title_id_alt);
+    m->title_id[strcspn(m->title_id, "\r\n")] = '\0';
+    m->content_name[strcspn(m->content_name, "\r\n")] = '\0';
+    return 0;
+}
+
+// Fills the fields param.json did not provide from the SFO table
+static void game_meta_parse_sfo(const sfo_t* s, game_meta_t* m) {
+    if (m->title_id[0] == '\0')
+        sfo_get_string(s, "TITLE_ID", m->title_id, sizeof(m->title_id));
+    if (m->content_name[0] == '\0')
+        sfo_get_string(s, "TITLE", m->content_name, sizeof(m->content_name));
+    if (m->content_version[0] == '\0' &&
+        sfo_get_string(s, "APP_VER", m->content_version, sizeof(m->content_version)) != 0)
+        sfo_get_string(s, "VERSION", m->content_version, sizeof(m->content_version));
+    if (m->content_id[0] == '\0')
+        sfo_get_string(s, "CONTENT_ID", m->content_id, sizeof(m->content_id));
+    sfo_get_string(s, "CATEGORY", m->category, sizeof(m->category));
+}
+
+static void game_meta_free(game_meta_t* m) {
+    if (m->json) munmap(m->json, m->json_len);
+    m->json = NULL;
+    m->json_len = 0;
+    sfo_free(&m->sfo);
+}
+
+// Fills m from param.json in the held sce_sys (mapped, parsed in place),
+// falling back to param.sfo (one read) when there is no param.json or it lacks
+// a title ID. Returns -1 if no title ID could be found.
+static int game_meta_load(const dir_t* sce_sys, game_meta_t* m) {
+    memset(m, 0, sizeof(*m));
+    if (sce_sys->fd < 0) return -1;
+
+    m->json = map_small_file(sce_sys, "param.json", 1024 * 1024, &m->json_len);
+
+    if (m->json)
+        game_meta_parse_json(m->json, m->json_len, m);
+
+    if (m->title_id[0] == '\0') {
+        if (sfo_load(sce_sys, "param.sfo", &m->sfo) == 0)
+            game_meta_parse_sfo(&m->sfo, m);
+    }
+    return m->title_id[0] ? 0 : -1;
+}
+
+// contentName, then the default language's title, then en-US, then any title
+static int game_meta_name(const game_meta_t* m, char* name, size_t size) {
+    if (m->content_name[0]) {
+        snprintf(name, size, "%s", m->content_name);
+        return 0;
+    }
+
+    const char* prefer[] = { m->default_language, "en-US" };
+    for (int p = 0; p < 2; p++) {
+        for (int i = 0; prefer[p][0] && i < m->num_names; i++) {
+            if (!strcmp(m->names[i].lang, prefer[p])) {
+                snprintf(name, size, "%s", m->names[i].title);
+                return 0;
+            }
+        }
+    }
+
+    if (m->num_names > 0) {
+        snprintf(name, size, "%s", m->names[0].title);
+        return 0;
+    }
+
+    // Root-level titleName used by some older dumps
+    if (m->json && json_get_string(m->json, m->json_len, "titleName", name, size) == 0)
+        return 0;
+
+    return -1;
+}
+
+// ---------------- CACHE SYSTEM ----------------
+// Incremental index keyed by source path. A game whose directory inode and
+// param.json/param.sfo mtime+size still match its entry is not re-parsed,
+// re-patched or re-copied on the next run.
+//
+// On disk the index is a versioned binary file that is mmap'd as-is:
+//
+//   cache_header_t | cache_record_t[count] | path index | title index | pool
+//
+// Both indexes are open-addressed tables of (record + 1), 0 meaning empty,
+// so a lookup is one hash and a short probe with no parsing at startup.
+// Strings (name, path) live NUL-terminated in the pool.
+#define CACHE_MAGIC    0x43474D47  // "GMGC"
+#define CACHE_VERSION  2
+#define CACHE_F_MOUNTED 0x1
+#define CACHE_F_DRM_OK  0x2   // param.json needs no DRM patch (or has none)
+
+typedef struct {
+    uint64_t inode;
+    int64_t json_mtime;
+    int64_t json_size;
+    int64_t sfo_mtime;
+    int64_t sfo_size;
+} game_fingerprint_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t record_count;
+    uint32_t index_slots;
+    uint32_t pool_size;
+    uint32_t records_off;
+    uint32_t path_index_off;
+    uint32_t title_index_off;
+    uint32_t pool_off;
+} cache_header_t;
+
+typedef struct {
+    game_fingerprint_t fp;
+    int64_t last_seen;
+    char title_id[12];
+    uint32_t name_off;
+    uint32_t path_off;
+    uint32_t flags;
+} cache_record_t;
+
+// What happened to a game folder this run (game_cache_entry_t.outcome)
+enum {
+    GAME_MOUNTED,
+    GAME_SKIPPED,    // already mounted from this folder
+    GAME_FAILED,
+    GAME_CLEANED,    // folder gone, title unmounted; not saved
+};
+
+// In-memory entry collected during a scan and written by save_cache().
+// Strings are interned in the registry arena (see GAME REGISTRY).
+typedef struct {
+    const char* path;
+    const char* name;
+    int64_t last_seen;
+    game_fingerprint_t fp;
+    char title_id[12];
+    uint32_t flags;             // CACHE_F_*
+    uint32_t outcome;           // GAME_*
+} game_cache_entry_t;
+
+typedef struct {
+    void* map;
+    size_t map_size;
+    const cache_header_t* hdr;
+    const cache_record_t* records;
+    const uint32_t* path_index;
+    const uint32_t* title_index;
+    const char* pool;
+} game_cache_t;
+
+static game_cache_t g_cache = {};
+
+static uint32_t cache_hash(const char* s) {
+    uint32_t h = 2166136261u;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// inode comes from the discovery pass (dirent.d_fileno), so only the two
+// param files in the held sce_sys need a stat here
+static void game_fingerprint(const dir_t* sce_sys, uint64_t inode, game_fingerprint_t* fp) {
+    struct stat st;
+
+    memset(fp, 0, sizeof(*fp));
+    fp->inode = inode;
+    if (sce_sys->fd < 0) return;
+
+    if (tr_fstatat(sce_sys, "param.json", &st, 0) == 0) {
+        fp->json_mtime = (int64_t)st.st_mtime;
+        fp->json_size = (int64_t)st.st_size;
+    }
+
+    if (tr_fstatat(sce_sys, "param.sfo", &st, 0) == 0) {
+        fp->sfo_mtime = (int64_t)st.st_mtime;
+        fp->sfo_size = (int64_t)st.st_size;
+    }
+}
+
+static int fingerprint_equal(const game_fingerprint_t* a, const game_fingerprint_t* b) {
+    return a->inode == b->inode &&
+           a->json_mtime == b->json_mtime && a->json_size == b->json_size &&
+           a->sfo_mtime == b->sfo_mtime && a->sfo_size == b->sfo_size;
+}
+
+static const char* cache_string(uint32_t off) {
+    return g_cache.pool + off;
+}
+
+static const cache_record_t* cache_lookup(const uint32_t* index, const char* key, int by_path) {
+    if (!g_cache.hdr || g_cache.hdr->record_count == 0) return NULL;
+
+    uint32_t mask = g_cache.hdr->index_slots - 1;
+    for (uint32_t i = cache_hash(key) & mask, n = 0; n <= mask; i = (i + 1) & mask, n++) {
+        uint32_t slot = index[i];
+        if (slot == 0) return NULL;
+
+        const cache_record_t* r = &g_cache.records[slot - 1];
+        const char* k = by_path ? cache_string(r->path_off) : r->title_id;
+        if (!strcmp(k, key)) return r;
+    }
+    return NULL;
+}
+
+static const cache_record_t* cache_find(const char* path) {
+    return cache_lookup(g_cache.path_index, path, 1);
+}
+
+static const cache_record_t* cache_find_title(const char* title_id) {
+    return cache_lookup(g_cache.title_index, title_id, 0);
+}
+
+static int cache_validate(const cache_header_t* h, size_t size) {
+    if (size < sizeof(*h) || h->magic != CACHE_MAGIC || h->version != CACHE_VERSION)
+        return -1;
+    if (h->record_size != sizeof(cache_record_t))
+        return -1;
+    if (h->index_slots == 0 || (h->index_slots & (h->index_slots - 1)) != 0 ||
+        h->index_slots < h->record_count)
+        return -1;
+
+    uint64_t index_bytes = (uint64_t)h->index_slots * sizeof(uint32_t);
+    if ((uint64_t)h->records_off + (uint64_t)h->record_count * sizeof(cache_record_t) > size ||
+        (uint64_t)h->path_index_off + index_bytes > size ||
+        (uint64_t)h->title_index_off + index_bytes > size ||
+        (uint64_t)h->pool_off + h->pool_size > size ||
+        h->pool_size == 0)
+        return -1;
+    if ((h->records_off | h->path_index_off | h->title_index_off) & 7)
+        return -1;
+
+    const char* pool = (const char*)h + h->pool_off;
+    if (pool[h->pool_size - 1] != '\0')
+        return -1;
+
+    const cache_record_t* records = (const cache_record_t*)((const char*)h + h->records_off);
+    for (uint32_t i = 0; i < h->record_count; i++) {
+        if (records[i].name_off >= h->pool_size || records[i].path_off >= h->pool_size ||
+            memchr(records[i].title_id, '\0', sizeof(records[i].title_id)) == NULL)
+            return -1;
+    }
+
+    const uint32_t* indexes[2] = {
+        (const uint32_t*)((const char*)h + h->path_index_off),
+        (const uint32_t*)((const char*)h + h->title_index_off),
+    };
+    for (int k = 0; k < 2; k++) {
+        for (uint32_t i = 0; i < h->index_slots; i++) {
+            if (indexes[k][i] > h->record_count)
+                return -1;
+        }
+    }
+    return 0;
+}
+
+static int load_cache(void) {
+    memset(&g_cache, 0, sizeof(g_cache));
+
+    int fd = open(CACHE_FILE, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(cache_header_t)) {
+        close(fd);
+        return -1;
+    }
+
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    const cache_header_t* h = (const cache_header_t*)map;
+    if (cache_validate(h, st.st_size) != 0) {
+        log_at(LOG_WARN, "Ignoring invalid cache file %s\n", CACHE_FILE);
+        munmap(map, st.st_size);
+        return -1;
+    }
+
+    g_cache.map = map;
+    g_cache.map_size = st.st_size;
+    g_cache.hdr = h;
+    g_cache.records = (const cache_record_t*)((const char*)map + h->records_off);
+    g_cache.path_index = (const uint32_t*)((const char*)map + h->path_index_off);
+    g_cache.title_index = (const uint32_t*)((const char*)map + h->title_index_off);
+    g_cache.pool = (const char*)map + h->pool_off;
+    return (int)h->record_count;
+}
+
+static void unload_cache(void) {
+    if (g_cache.map) {
+        munmap(g_cache.map, g_cache.map_size);
+    }
+    memset(&g_cache, 0, sizeof(g_cache));
+}
+
+static void cache_index_insert(uint32_t* index, uint32_t slots, const char* key, uint32_t record) {
+    uint32_t mask = slots - 1;
+    uint32_t i = cache_hash(key) & mask;
+    while (index[i] != 0)
+        i = (i + 1) & mask;
+    index[i] = record + 1;
+}
+
+static uint32_t align8(uint32_t v) {
+    return (v + 7) & ~7u;
+}
+
+// Builds the whole file in memory, then writes it to a temp file and renames
+// it over CACHE_FILE so a crash never leaves a half-written cache behind.
+// Returns the number of records written.
+static int save_cache(const game_cache_entry_t* entries, int count) {
+    uint32_t slots = 16;
+    while (slots < (uint32_t)count * 2)
+        slots <<= 1;
+
+    uint32_t pool_size = 1;  // offset 0 is the empty string
+    for (int i = 0; i < count; i++)
+        pool_size += strlen(entries[i].name) + 1 + strlen(entries[i].path) + 1;
+
+    cache_header_t h = {};
+    h.magic = CACHE_MAGIC;
+    h.version = CACHE_VERSION;
+    h.record_size = sizeof(cache_record_t);
+    h.index_slots = slots;
+    h.pool_size = pool_size;
+    h.records_off = align8(sizeof(cache_header_t));
+    h.path_index_off = align8(h.records_off + count * sizeof(cache_record_t));
+    h.title_index_off = align8(h.path_index_off + slots * sizeof(uint32_t));
+    h.pool_off = align8(h.title_index_off + slots * sizeof(uint32_t));
+
+    size_t file_size = h.pool_off + pool_size;
+    char* buf = (char*)calloc(1, file_size);
+    if (!buf) return -1;
+
+    cache_record_t* records = (cache_record_t*)(buf + h.records_off);
+    uint32_t* path_index = (uint32_t*)(buf + h.path_index_off);
+    uint32_t* title_index = (uint32_t*)(buf + h.title_index_off);
+    char* pool = buf + h.pool_off;
+    uint32_t pool_pos = 1;
+    uint32_t n = 0;
+
+    for (int i = 0; i < count; i++) {
+        const game_cache_entry_t* e = &entries[i];
+        if (e->title_id[0] == '\0' || e->outcome == GAME_CLEANED) continue;
+
+        cache_record_t* r = &records[n];
+        r->fp = e->fp;
+        r->last_seen = e->last_seen;
+        snprintf(r->title_id, sizeof(r->title_id), "%s", e->title_id);
+        r->flags = e->flags;
+
+        r->name_off = pool_pos;
+        pool_pos += snprintf(pool + pool_pos, pool_size - pool_pos, "%s", e->name) + 1;
+        r->path_off = pool_pos;
+        pool_pos += snprintf(pool + pool_pos, pool_size - pool_pos, "%s", e->path) + 1;
+
+        cache_index_insert(path_index, slots, e->path, n);
+        cache_index_insert(title_index, slots, r->title_id, n);
+        n++;
+    }
+    h.record_count = n;
+    memcpy(buf, &h, sizeof(h));
+
+    char tmp_path[PATH_MAX];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", CACHE_FILE);
+
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        free(buf);
+        return -1;
+    }
+
+    size_t done = 0;
+    while (done < file_size) {
+        ssize_t w = write(fd, buf + done, file_size - done);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) break;
+        done += w;
+    }
+    free(buf);
+
+    if (done != file_size || fsync(fd) != 0) {
+        close(fd);
+        unlink(tmp_path);
+        return -1;
+    }
+    close(fd);
+
+    if (rename(tmp_path, CACHE_FILE) != 0) {
+        unlink(tmp_path);
+        return -1;
+    }
+    return (int)n;
+}
+
+static void json_write_string(FILE* f, const char* s) {
+    fputc('"', f);
+    for (; *s; s++) {
+        switch (*s) {
+            case '"':  fputs("\\\"", f); break;
+            case '\\': fputs("\\\\", f); break;
+            case '\n': fputs("\\n", f); break;
+            case '\r': fputs("\\r", f); break;
+            case '\t': fputs("\\t", f); break;
+            default:   fputc(*s, f); break;
+        }
+    }
+    fputc('"', f);
+}
+
+// Human-readable dump of the loaded binary cache (game_mounter --dump-cache)
+static int dump_cache_json(const char* out_path) {
+    FILE* f = fopen(out_path, "w");
+    if (!f) return -1;
+
+    uint32_t count = g_cache.hdr ? g_cache.hdr->record_count : 0;
+
+    fprintf(f, "{\n  \"version\": %d,\n  \"games\": [", CACHE_VERSION);
+    for (uint32_t i = 0; i < count; i++) {
+        const cache_record_t* r = &g_cache.records[i];
+        fprintf(f, "%s\n    {\n", i ? "," : "");
+        fprintf(f, "      \"title_id\": ");
+        json_write_string(f, r->title_id);
+        fprintf(f, ",\n      \"name\": ");
+        json_write_string(f, cache_string(r->name_off));
+        fprintf(f, ",\n      \"path\": ");
+        json_write_string(f, cache_string(r->path_off));
+        fprintf(f, ",\n      \"last_seen\": %lld,\n", (long long)r->last_seen);
+        fprintf(f, "      \"inode\": %llu,\n", (unsigned long long)r->fp.inode);
+        fprintf(f, "      \"json_mtime\": %lld,\n", (long long)r->fp.json_mtime);
+        fprintf(f, "      \"json_size\": %lld,\n", (long long)r->fp.json_size);
+        fprintf(f, "      \"sfo_mtime\": %lld,\n", (long long)r->fp.sfo_mtime);
+        fprintf(f, "      \"sfo_size\": %lld,\n", (long long)r->fp.sfo_size);
+        fprintf(f, "      \"mounted\": %s,\n", (r->flags & CACHE_F_MOUNTED) ? "true" : "false");
+        fprintf(f, "      \"drm_ok\": %s\n", (r->flags & CACHE_F_DRM_OK) ? "true" : "false");
+        fprintf(f, "    }");
+    }
+    fprintf(f, "\n  ]\n}\n");
+    fclose(f);
+    return (int)count;
+}
+
+// ---------------- PATCH DRM (PS5 only) ----------------
+// The already-"standard" case only looks at the mapped param.json. A patch is
+// written to a temp file next to it (head, "standard", tail straight from the
+// mapping), fsync'd and renamed over the original, so an interrupted write
+// never leaves a truncated param.json behind.
+static int fix_application_drm_type(const dir_t* sce_sys, game_meta_t* meta) {
+    static const char standard[] = "standard";
+    const size_t std_len = sizeof(standard) - 1;
+
+    if (!meta->json) return -1;
+
+    const char* buf = meta->json;
+
+    json_value_t v;
+    if (json_query(buf, meta->json_len, "applicationDrmType", &v) != 0) return 0;
+    if (v.type != JSON_STRING) return -1;
+
+    if (v.len == std_len && !memcmp(v.start, standard, std_len)) {
+        return 0;
+    }
+
+    double t = trace_begin();
+    int fd = openat(sce_sys->fd, "param.json.tmp", O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        trace_end_at(TR_WRITE, sce_sys, "param.json", NULL, 0, -errno, 0, 0, t);
+        return -1;
+    }
+
+    // Replace the string body between the quotes
+    size_t head = v.start - buf;
+    size_t tail = meta->json_len - (head + v.len);
+    int ok = write_all(fd, buf, head) == 0 &&
+             write_all(fd, standard, std_len) == 0 &&
+             write_all(fd, v.start + v.len, tail) == 0 &&
+             fsync(fd) == 0;
+
+    if (close(fd) != 0 || !ok || renameat(sce_sys->fd, "param.json.tmp", sce_sys->fd, "param.json") != 0) {
+        trace_end_at(TR_WRITE, sce_sys, "param.json", NULL, 0, -errno, 0, 0, t);
+        unlinkat(sce_sys->fd, "param.json.tmp", 0);
+        return -1;
+    }
+    trace_end_at(TR_WRITE, sce_sys, "param.json", NULL, 0, 0, meta->json_len - v.len + std_len, 0, t);
+
+    // meta->json still maps the old inode; only the parsed field changes
+    snprintf(meta->drm_type, sizeof(meta->drm_type), "%s", standard);
+    return 1;
+}
+
+// ---------------- CHECK IF ALREADY MOUNTED ----------------
+// Reads the game folder a title was mounted from (/user/app/<TITLE>/mount.lnk);
+// returns 0 if there is one
+static int read_mount_lnk(const char* title_id, char* out, size_t size) {
+    char name[32];
+    snprintf(name, sizeof(name), "%s/mount.lnk", title_id);
+    out[0] = '\0';
+
+    double t = trace_begin();
+    int fd = openat(g_user_app.fd, name, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        trace_end_at(TR_READ, &g_user_app, name, NULL, 0, -errno, 0, 0, t);
+        return -1;
+    }
+    ssize_t n;
+    while ((n = read(fd, out, size - 1)) < 0 && errno == EINTR)
+        ;
+    close(fd);
+    out[n > 0 ? n : 0] = '\0';
+    out[strcspn(out, "\r\n")] = '\0';
+    trace_end_at(TR_READ, &g_user_app, name, out, strlen(out), 0, strlen(out), 0, t);
+    return out[0] ? 0 : -1;
+}
+
+static int is_game_already_mounted(const char* title_id, const char* game_path) {
+    char system_ex_app[PATH_MAX];
+    char existing_path[PATH_MAX];
     
-    // PS4 games (CUSA prefix)
-    if (strncmp(title_id, "CUSA", 4) == 0) {
-        char region_code = title_id[4];
-        switch (region_code) {
-            case '0': return "US";
-            case '1': return "EU";
-            case '2': return "JP";
-            case '3': return "Asia";
-            case '4': return "UK";
-            case '5': return "KR";
-            default: return "World";
+    // Check if mount.lnk exists and points to the same path
+    if (read_mount_lnk(title_id, existing_path, sizeof(existing_path)) != 0 ||
+        strcmp(existing_path, game_path) != 0)
+        return 0;  // Not mounted or different path
+
+    // Also verify the nullfs mount is still active, from that path
+    char source[PATH_MAX];
+    snprintf(system_ex_app, sizeof(system_ex_app),
+             GM_ROOT "/system_ex/app/%s", title_id);
+    if (mount_source(system_ex_app, source, sizeof(source))) {
+        if (mount_source_matches(source, game_path))
+            return 1;  // Already mounted
+        log_at(LOG_WARN, "  %s is mounted from %s, mount.lnk says %s\n",
+                title_id, source, game_path);
+    }
+    return 0;
+}
+
+// ---------------- GAME REGISTRY ----------------
+// Every game folder seen since startup and what happened to it, shared by the
+// work list, the summary and save_cache(). Paths and names are interned in an
+// arena of 64 KB blocks that are never moved or freed before exit, so entries
+// (and work items) hold plain pointers and a folder seen again in daemon mode
+// reuses its strings. The entry array grows by doubling; an open-addressed
+// path index keeps record_game() O(1) at 10k titles.
+#define ARENA_BLOCK (64 * 1024)
+
+typedef struct arena_block {
+    struct arena_block* next;
+    size_t used;
+    size_t size;
+} arena_block_t;
+
+typedef struct {
+    game_cache_entry_t* items;
+    int count;
+    int capacity;
+    uint32_t* index;            // path -> item + 1, 0 = empty
+    uint32_t index_slots;
+    const char** strings;       // interned strings, open-addressed
+    uint32_t string_slots;
+    uint32_t string_count;
+    arena_block_t* blocks;
+    size_t arena_bytes;
+} game_registry_t;
+
+static game_registry_t g_registry = {};
+static pthread_mutex_t g_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static char* arena_alloc(size_t len) {
+    arena_block_t* b = g_registry.blocks;
+    if (!b || b->size - b->used < len) {
+        size_t size = len > ARENA_BLOCK ? len : ARENA_BLOCK;
+        b = (arena_block_t*)malloc(sizeof(arena_block_t) + size);
+        if (!b) return NULL;
+        b->next = g_registry.blocks;
+        b->used = 0;
+        b->size = size;
+        g_registry.blocks = b;
+        g_registry.arena_bytes += sizeof(arena_block_t) + size;
+    }
+    char* p = (char*)(b + 1) + b->used;
+    b->used += len;
+    return p;
+}
+
+static int intern_grow(void) {
+    uint32_t slots = g_registry.string_slots ? g_registry.string_slots * 2 : 256;
+    const char** strings = (const char**)calloc(slots, sizeof(const char*));
+    if (!strings) return -1;
+
+    for (uint32_t i = 0; i < g_registry.string_slots; i++) {
+        const char* s = g_registry.strings[i];
+        if (!s) continue;
+        uint32_t j = cache_hash(s) & (slots - 1);
+        while (strings[j])
+            j = (j + 1) & (slots - 1);
+        strings[j] = s;
+    }
+    free(g_registry.strings);
+    g_registry.strings = strings;
+    g_registry.string_slots = slots;
+    return 0;
+}
+
+// Caller holds g_registry_lock
+static const char* intern_locked(const char* s) {
+    if ((g_registry.string_count + 1) * 2 > g_registry.string_slots && intern_grow() != 0)
+        return NULL;
+
+    uint32_t mask = g_registry.string_slots - 1;
+    uint32_t i = cache_hash(s) & mask;
+    while (g_registry.strings[i]) {
+        if (!strcmp(g_registry.strings[i], s)) return g_registry.strings[i];
+        i = (i + 1) & mask;
+    }
+
+    size_t len = strlen(s) + 1;
+    char* copy = arena_alloc(len);
+    if (!copy) return NULL;
+    memcpy(copy, s, len);
+    g_registry.strings[i] = copy;
+    g_registry.string_count++;
+    return copy;
+}
+
+// Returns a copy of s that lives until registry_free(); NULL if out of memory
+static const char* intern(const char* s) {
+    pthread_mutex_lock(&g_registry_lock);
+    const char* r = intern_locked(s);
+    pthread_mutex_unlock(&g_registry_lock);
+    return r;
+}
+
+static void registry_index_insert(uint32_t* index, uint32_t slots, const char* path, int item) {
+    uint32_t i = cache_hash(path) & (slots - 1);
+    while (index[i])
+        i = (i + 1) & (slots - 1);
+    index[i] = (uint32_t)item + 1;
+}
+
+static int registry_find_locked(const char* path) {
+    if (!g_registry.index) return -1;
+    uint32_t mask = g_registry.index_slots - 1;
+    for (uint32_t i = cache_hash(path) & mask; g_registry.index[i]; i = (i + 1) & mask) {
+        int item = (int)g_registry.index[i] - 1;
+        if (!strcmp(g_registry.items[item].path, path)) return item;
+    }
+    return -1;
+}
+
+static game_cache_entry_t* registry_add_locked(const char* path) {
+    if (g_registry.count == g_registry.capacity) {
+        int cap = g_registry.capacity ? g_registry.capacity * 2 : 64;
+        game_cache_entry_t* items = (game_cache_entry_t*)realloc(g_registry.items, cap * sizeof(*items));
+        if (!items) return NULL;
+        g_registry.items = items;
+        g_registry.capacity = cap;
+    }
+    if ((uint32_t)(g_registry.count + 1) * 2 > g_registry.index_slots) {
+        uint32_t slots = g_registry.index_slots ? g_registry.index_slots * 2 : 128;
+        uint32_t* index = (uint32_t*)calloc(slots, sizeof(uint32_t));
+        if (!index) return NULL;
+        for (int i = 0; i < g_registry.count; i++)
+            registry_index_insert(index, slots, g_registry.items[i].path, i);
+        free(g_registry.index);
+        g_registry.index = index;
+        g_registry.index_slots = slots;
+    }
+
+    const char* key = intern_locked(path);
+    if (!key) return NULL;
+    game_cache_entry_t* e = &g_registry.items[g_registry.count];
+    memset(e, 0, sizeof(*e));
+    e->path = key;
+    e->name = "";
+    e->outcome = GAME_FAILED;
+    registry_index_insert(g_registry.index, g_registry.index_slots, key, g_registry.count++);
+    return e;
+}
+
+static void record_game(const char* title_id, const char* name, const char* path,
+                        const game_fingerprint_t* fp, uint32_t flags, uint32_t outcome) {
+    pthread_mutex_lock(&g_registry_lock);
+    // A folder processed again (daemon mode) replaces its earlier entry
+    int i = registry_find_locked(path);
+    game_cache_entry_t* e = (i >= 0) ? &g_registry.items[i] : registry_add_locked(path);
+    const char* interned = e ? intern_locked(name) : NULL;
+    if (interned) {
+        snprintf(e->title_id, sizeof(e->title_id), "%s", title_id);
+        e->name = interned;
+        e->last_seen = (int64_t)time(NULL);
+        if (fp) e->fp = *fp;
+        else memset(&e->fp, 0, sizeof(e->fp));
+        e->flags = flags;
+        e->outcome = outcome;
+    } else {
+        log_at(LOG_WARN, "  Out of memory, %s will not be cached\n", path);
+    }
+    pthread_mutex_unlock(&g_registry_lock);
+}
+
+// Marks a folder that no longer exists as cleaned; returns its title ID
+static int forget_game(const char* path, char* title_id, size_t size) {
+    int found = -1;
+    pthread_mutex_lock(&g_registry_lock);
+    int i = registry_find_locked(path);
+    if (i >= 0 && g_registry.items[i].outcome != GAME_CLEANED) {
+        snprintf(title_id, size, "%s", g_registry.items[i].title_id);
+        g_registry.items[i].outcome = GAME_CLEANED;
+        g_registry.items[i].last_seen = (int64_t)time(NULL);
+        found = 0;
+    }
+    pthread_mutex_unlock(&g_registry_lock);
+    return found;
+}
+
+static int registry_save(void) {
+    pthread_mutex_lock(&g_registry_lock);
+    int rc = save_cache(g_registry.items, g_registry.count);
+    pthread_mutex_unlock(&g_registry_lock);
+    return rc;
+}
+
+static void registry_free(void) {
+    while (g_registry.blocks) {
+        arena_block_t* next = g_registry.blocks->next;
+        free(g_registry.blocks);
+        g_registry.blocks = next;
+    }
+    free(g_registry.items);
+    free(g_registry.index);
+    free(g_registry.strings);
+    memset(&g_registry, 0, sizeof(g_registry));
+}
+
+// ---------------- DISCOVERY ----------------
+// One readdir pass per root builds the work list that the processing phase
+// and the progress counter consume. dirent.d_type answers "is this a
+// directory" without a stat; only DT_UNKNOWN (and symlinks, which are
+// followed like before) cost a stat round trip.
+typedef struct {
+    const char* path;  // interned
+    const char* name;  // interned display name with region, once processed
+    uint64_t inode;
+    int root_idx;
+    int result;        // process_game() return value
+} game_work_t;
+
+typedef struct {
+    game_work_t* items;
+    int count;
+    int capacity;
+    int root_available[NUM_GAME_PATHS];
+    int root_partial[NUM_GAME_PATHS];    // listing stopped early (out of memory, read error)
+    uint64_t root_dev[NUM_GAME_PATHS];   // st_dev of each available root
+} game_work_list_t;
+
+static int work_list_push(game_work_list_t* list, const char* path, int root_idx, uint64_t inode) {
+    if (list->count == list->capacity) {
+        int cap = list->capacity ? list->capacity * 2 : 64;
+        game_work_t* items = (game_work_t*)realloc(list->items, cap * sizeof(game_work_t));
+        if (!items) return -1;
+        list->items = items;
+        list->capacity = cap;
+    }
+
+    const char* key = intern(path);
+    if (!key) return -1;
+
+    game_work_t* w = &list->items[list->count++];
+    memset(w, 0, sizeof(*w));
+    w->result = -1;
+    w->path = key;
+    w->root_idx = root_idx;
+    w->inode = inode;
+    return 0;
+}
+
+static void work_list_free(game_work_list_t* list) {
+    free(list->items);
+    memset(list, 0, sizeof(*list));
+}
+
+// Adds the game folders of one GAME_PATHS root; -1 if the root is unavailable.
+// The root's fd is held in g_roots[] until the next discovery of that root.
+static int discover_root(game_work_list_t* list, int path_idx) {
+    const char* base_path = GAME_PATHS[path_idx];
+    dir_t* root = &g_roots[path_idx];
+
+    // Opening the root doubles as its existence check
+    dir_close(root);
+    DIR* d = dir_open(root, NULL, base_path) == 0 ? dir_list(root) : NULL;
+    if (!d) {
+        dir_close(root);
+        if (errno == ENOENT || errno == ENOTDIR) {
+            log_msg("  [%d/%d] Skipping %s (not found)\n", path_idx + 1, (int)NUM_GAME_PATHS, base_path);
+        } else {
+            log_at(LOG_WARN, "  Cannot open %s (errno: %d)\n", base_path, errno);
+        }
+        return -1;
+    }
+
+    list->root_available[path_idx] = 1;
+    int found = 0;
+
+    struct stat root_st;
+    if (fstat(root->fd, &root_st) == 0)
+        list->root_dev[path_idx] = (uint64_t)root_st.st_dev;
+
+    struct dirent* e;
+    for (;;) {
+        errno = 0;
+        if (!(e = readdir(d))) {
+            if (errno != 0) {
+                log_at(LOG_ERROR, "  Cannot read %s (errno: %d)\n", base_path, errno);
+                list->root_partial[path_idx] = 1;
+            }
+            break;
+        }
+        if (!strcmp(e->d_name, ".") || !strcmp(e->d_name, ".."))
+            continue;
+        if (e->d_type != DT_DIR && e->d_type != DT_UNKNOWN && e->d_type != DT_LNK)
+            continue;
+
+        char game_path[PATH_MAX];
+        snprintf(game_path, sizeof(game_path), "%s/%s", base_path, e->d_name);
+
+        uint64_t inode = (uint64_t)e->d_fileno;
+        if (e->d_type != DT_DIR) {
+            struct stat st;
+            if (fstatat(root->fd, e->d_name, &st, 0) != 0 || !S_ISDIR(st.st_mode))
+                continue;
+            inode = (uint64_t)st.st_ino;
+        }
+
+        if (work_list_push(list, game_path, path_idx, inode) != 0) {
+            log_at(LOG_ERROR, "  Out of memory while scanning %s\n", base_path);
+            list->root_partial[path_idx] = 1;
+            break;
+        }
+        found++;
+    }
+    closedir(d);
+
+    log_msg("  [%d/%d] Scanned: %s (%d entries)\n", path_idx + 1, (int)NUM_GAME_PATHS, base_path, found);
+    return found;
+}
+
+// Opens a game folder relative to its held root, by full path if the root
+// isn't held (e.g. the daemon saw it before a rescan)
+static int game_dir_open(dir_t* d, const game_work_t* work) {
+    const dir_t* root = &g_roots[work->root_idx];
+    size_t n = strlen(root->path);
+    if (root->fd >= 0 && !strncmp(work->path, root->path, n) && work->path[n] == '/')
+        return dir_open(d, root, work->path + n + 1);
+    return dir_open(d, NULL, work->path);
+}
+
+static int discover_games(game_work_list_t* list) {
+    for (int path_idx = 0; path_idx < (int)NUM_GAME_PATHS; path_idx++)
+        discover_root(list, path_idx);
+    return list->count;
+}
+
+// Set of the game folders discovery found: full paths plus folder names
+// (for <TITLE>-app lookups). Keys point at interned paths, nothing is copied.
+// A root whose listing stopped early is not answered from the set.
+typedef struct {
+    const char** slots;
+    uint32_t mask;
+    int partial[NUM_GAME_PATHS];
+    int any_partial;
+} path_set_t;
+
+static void path_set_insert(path_set_t* set, const char* key) {
+    uint32_t i = cache_hash(key) & set->mask;
+    while (set->slots[i]) {
+        if (!strcmp(set->slots[i], key)) return;
+        i = (i + 1) & set->mask;
+    }
+    set->slots[i] = key;
+}
+
+static int path_set_has(const path_set_t* set, const char* key) {
+    if (!set->slots) return 0;
+    uint32_t i = cache_hash(key) & set->mask;
+    while (set->slots[i]) {
+        if (!strcmp(set->slots[i], key)) return 1;
+        i = (i + 1) & set->mask;
+    }
+    return 0;
+}
+
+static int path_set_build(path_set_t* set, const game_work_list_t* list) {
+    uint32_t size = 16;
+    while (size < (uint32_t)list->count * 4)
+        size <<= 1;
+
+    set->slots = (const char**)calloc(size, sizeof(const char*));
+    if (!set->slots) return -1;
+    set->mask = size - 1;
+
+    for (int i = 0; i < (int)NUM_GAME_PATHS; i++) {
+        set->partial[i] = list->root_partial[i];
+        set->any_partial |= list->root_partial[i];
+    }
+    for (int i = 0; i < list->count; i++) {
+        const char* path = list->items[i].path;
+        const char* name = strrchr(path, '/');
+        path_set_insert(set, path);
+        if (name) path_set_insert(set, name + 1);
+    }
+    return 0;
+}
+
+static void path_set_free(path_set_t* set) {
+    free(set->slots);
+    memset(set, 0, sizeof(*set));
+}
+
+// Registration goes through the system app database one title at a time
+static pthread_mutex_t register_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Two folders carrying the same title ID must not mount/copy concurrently
+#define TITLE_LOCKS 16
+static pthread_mutex_t title_locks[TITLE_LOCKS];
+static pthread_once_t title_locks_once = PTHREAD_ONCE_INIT;
+
+static void title_locks_init(void) {
+    for (int i = 0; i < TITLE_LOCKS; i++)
+        pthread_mutex_init(&title_locks[i], NULL);
+}
+
+static pthread_mutex_t* title_lock(const char* title_id) {
+    pthread_once(&title_locks_once, title_locks_init);
+    return &title_locks[cache_hash(title_id) % TITLE_LOCKS];
+}
+
+// ---------------- PROCESS ONE GAME ----------------
+// sce_sys is the game's held sce_sys folder (fd -1 if it has none)
+static int process_game_at(const game_work_t* work, const dir_t* sce_sys,
+                           char* game_name_out, size_t name_size, int current, int total) {
+    const char* game_path = work->path;
+    int root = work->root_idx;
+    double t = monotonic_ms();
+    char title_id[12] = {};
+    char game_name[256] = "Unknown Game";
+    char system_ex_app[PATH_MAX];
+
+    // Consult the incremental index before touching param.json/param.sfo
+    game_fingerprint_t fp;
+    game_fingerprint(sce_sys, work->inode, &fp);
+    const cache_record_t* cached = cache_find(game_path);
+    int unchanged = cached && fingerprint_equal(&cached->fp, &fp);
+    // DRM state recorded by an earlier run; param.json isn't reopened to check
+    uint32_t drm_ok = (unchanged && (cached->flags & CACHE_F_DRM_OK)) ? CACHE_F_DRM_OK : 0;
+
+    game_meta_t meta = {};
+
+    if (unchanged) {
+        snprintf(title_id, sizeof(title_id), "%s", cached->title_id);
+        snprintf(game_name, sizeof(game_name), "%s", cache_string(cached->name_off));
+        if (!drm_ok)
+            game_meta_load(sce_sys, &meta);
+    } else {
+        if (game_meta_load(sce_sys, &meta)) {
+            game_meta_free(&meta);
+            timing_span(PH_PARSE, root, t);
+            const char* folder = strrchr(game_path, '/');
+            record_game("", folder ? folder + 1 : game_path, game_path, &fp, 0, GAME_FAILED);
+            log_msg("\n=== [SKIP] Could not read Title ID from %s ===\n", game_path);
+            return -1;
+        }
+        snprintf(title_id, sizeof(title_id), "%s", meta.title_id);
+
+        if (game_meta_name(&meta, game_name, sizeof(game_name)) != 0) {
+            // If name extraction fails, use Title ID
+            snprintf(game_name, sizeof(game_name), "%s", title_id);
+        }
+
+        const cache_record_t* moved = cache_find_title(title_id);
+        if (moved && strcmp(cache_string(moved->path_off), game_path) != 0) {
+            log_msg("  [INFO] %s was previously indexed at %s\n",
+                    title_id, cache_string(moved->path_off));
+        }
+    }
+    t = timing_span(PH_PARSE, root, t);
+
+    // Get region
+    const char* region = get_game_region(title_id);
+    
+    // Add region to game name for display
+    char game_name_with_region[300];
+    snprintf(game_name_with_region, sizeof(game_name_with_region), "%s [%s]", game_name, region);
+
+    log_msg("\n=== [%d/%d] %s (%s)%s ===\n", current, total, game_name_with_region, title_id,
+            unchanged ? " [cached]" : "");
+    
+    // Progress notification; the sender thread shows the latest one
+    notify_progress(current, total, game_name_with_region);
+    
+    // Copy game name with region to output if provided
+    if (game_name_out && name_size > 0) {
+        snprintf(game_name_out, name_size, "%s [%s]", game_name, region);
+    }
+    
+    // Serialize everything below against another folder with the same title
+    pthread_mutex_t* tl = title_lock(title_id);
+    pthread_mutex_lock(tl);
+
+    // Already mounted from this folder: nothing to do unless the cache says
+    // it changed since, in which case the mount is kept and the metadata
+    // resynced and registered again below
+    int mounted_here = is_game_already_mounted(title_id, game_path);
+    if (mounted_here && (unchanged || !cached)) {
+        pthread_mutex_unlock(tl);
+        game_meta_free(&meta);
+        log_msg("  [SKIP] Already mounted\n");
+        record_game(title_id, game_name, game_path, &fp, CACHE_F_MOUNTED | drm_ok, GAME_SKIPPED);
+        return 2;  // Return 2 to indicate skipped
+    }
+
+    t = monotonic_ms();
+    if (!drm_ok) {
+        int patched = fix_application_drm_type(sce_sys, &meta);
+        if (patched > 0) {
+            log_msg("  [OK] DRM patched\n");
+            game_fingerprint(sce_sys, work->inode, &fp);
+        } else if (patched < 0 && meta.json) {
+            log_at(LOG_WARN, "  Could not patch applicationDrmType: %s\n", strerror(errno));
+        }
+        // SFO-only titles have no param.json to patch
+        if (patched >= 0 || fp.json_size == 0)
+            drm_ok = CACHE_F_DRM_OK;
+        t = timing_span(PH_DRM, root, t);
+    }
+    game_meta_free(&meta);
+
+    snprintf(system_ex_app, sizeof(system_ex_app),
+             GM_ROOT "/system_ex/app/%s", title_id);
+
+    if (mounted_here) {
+        log_msg("  [INFO] Changed since it was mounted, resyncing\n");
+    } else {
+        tr_mkdirat(&g_system_ex_app, title_id, 0755);
+
+        if (is_mounted(system_ex_app)) {
+            log_msg("  [INFO] Already mounted, unmounting...\n");
+            unmount_path(system_ex_app, 0);
+        }
+
+        if (mount_nullfs(game_path, system_ex_app)) {
+            int err = errno;
+            pthread_mutex_unlock(tl);
+            log_at(LOG_ERROR, "  Failed to mount: %s (errno: %d)\n", strerror(err), err);
+            record_game(title_id, game_name, game_path, &fp, drm_ok, GAME_FAILED);
+            timing_span(PH_MOUNT, root, t);
+            return -1;
+        }
+        t = timing_span(PH_MOUNT, root, t);
+        log_msg("  [OK] Mounted to %s\n", system_ex_app);
+    }
+
+    // /user/app/<TITLE> is held for the metadata copy and mount.lnk
+    dir_t user_app = { -1 };
+    if ((tr_mkdirat(&g_user_app, title_id, 0755) != 0 && errno != EEXIST) ||
+        dir_open(&user_app, &g_user_app, title_id) != 0)
+        log_at(LOG_WARN, "  Cannot open %s/%s (errno: %d)\n", g_user_app.path, title_id, errno);
+
+    // Metadata from a previous install is still valid if the source is unchanged
+    struct stat st;
+    int have_meta = unchanged && (cached->flags & CACHE_F_MOUNTED) &&
+                    tr_fstatat(&user_app, "sce_sys", &st, 0) == 0 && S_ISDIR(st.st_mode);
+
+    if (have_meta) {
+        log_msg("  [OK] Metadata unchanged, copy skipped\n");
+    } else {
+        sync_stats_t app_sync = {}, meta_sync = {};
+        install_metadata(sce_sys, &user_app, title_id, &app_sync, &meta_sync);
+        timing_span(PH_COPY, root, t);
+
+        log_msg("  [OK] sce_sys synced: %d file(s), %lld KB written, %d unchanged, %d pruned\n",
+                app_sync.files_copied + meta_sync.files_copied,
+                (app_sync.bytes_copied + meta_sync.bytes_copied) / 1024,
+                app_sync.files_unchanged + meta_sync.files_unchanged,
+                app_sync.files_pruned + meta_sync.files_pruned);
+    }
+
+    t = monotonic_ms();
+    pthread_mutex_lock(&register_lock);
+    double tr = trace_begin();
+    int reg = sceAppInstUtilAppInstallTitleDir(title_id, GM_ROOT "/user/app/", 0);
+    trace_end(TR_REGISTER, title_id, NULL, 0, reg, 0, 0, tr);
+    pthread_mutex_unlock(&register_lock);
+    t = timing_span(PH_REGISTER, root, t);
+
+    if (reg) {
+        pthread_mutex_unlock(tl);
+        dir_close(&user_app);
+        log_at(LOG_ERROR, "  Registration failed for %s\n", title_id);
+        record_game(title_id, game_name, game_path, &fp, drm_ok, GAME_FAILED);
+        return -1;
+    }
+
+    tr = trace_begin();
+    int fd = openat(user_app.fd, "mount.lnk", O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    int lnk = fd < 0 ? -errno : 0;
+    if (fd >= 0) {
+        if (write_all(fd, game_path, strlen(game_path)) != 0) lnk = -errno;
+        if (close(fd) != 0 && lnk == 0) lnk = -errno;
+    }
+    trace_end_at(TR_WRITE, &user_app, "mount.lnk", NULL, 0, lnk, strlen(game_path), 0, tr);
+    timing_span(PH_MOUNT_LNK, root, t);
+    pthread_mutex_unlock(tl);
+    dir_close(&user_app);
+
+    update_snd0info(title_id);
+
+    log_msg("  [SUCCESS] %s installed!\n", title_id);
+    
+    // Add to cache
+    record_game(title_id, game_name, game_path, &fp, CACHE_F_MOUNTED | drm_ok, GAME_MOUNTED);
+    
+    return 0;
+}
+
+static int process_game(const game_work_t* work, char* game_name_out, size_t name_size, int current, int total) {
+    dir_t game_dir = { -1 }, sce_sys = { -1 };
+
+    // The folder and its sce_sys are held while the game is processed
+    if (game_dir_open(&game_dir, work) == 0)
+        dir_open(&sce_sys, &game_dir, "sce_sys");
+
+    int rc = process_game_at(work, &sce_sys, game_name_out, name_size, current, total);
+    dir_close(&sce_sys);
+    dir_close(&game_dir);
+    return rc;
+}
+
+// ---------------- FAST START ----------------
+// Titles the cache says were mounted are put back before the full scan has
+// reached them, most recently seen first. The cached folder must still be
+// there with the same inode, /user/app/<TITLE>/sce_sys must exist and its
+// mount.lnk must name that folder; anything else is left to the scan. The
+// title is then mounted and registered again from that metadata.
+// Discovery runs on its own thread meanwhile. When the workers later get to
+// a restored game, they skip it if its fingerprint still matches the cache;
+// a changed one keeps its mount but is resynced and registered again.
+static int g_fast_start = 1;
+
+static int cmp_last_seen(const void* a, const void* b) {
+    int64_t x = (*(const cache_record_t* const*)a)->last_seen;
+    int64_t y = (*(const cache_record_t* const*)b)->last_seen;
+    return (x < y) - (x > y);
+}
+
+// Returns the number of titles restored
+static int fast_start_restore(void) {
+    uint32_t n = g_cache.hdr ? g_cache.hdr->record_count : 0;
+    const cache_record_t** order = (const cache_record_t**)malloc((n + 1) * sizeof(*order));
+    if (!order) return 0;
+
+    int count = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        if ((g_cache.records[i].flags & CACHE_F_MOUNTED) && g_cache.records[i].title_id[0])
+            order[count++] = &g_cache.records[i];
+    }
+    qsort(order, count, sizeof(*order), cmp_last_seen);
+
+    int restored = 0;
+    char system_ex_app[PATH_MAX];
+    char linked[PATH_MAX];
+    for (int i = 0; i < count; i++) {
+        const cache_record_t* r = order[i];
+        const char* path = cache_string(r->path_off);
+        const char* title_id = r->title_id;
+
+        // Still mounted (no reboot since), or already taken by another folder
+        snprintf(system_ex_app, sizeof(system_ex_app), GM_ROOT "/system_ex/app/%s", title_id);
+        if (is_mounted(system_ex_app))
+            continue;
+
+        struct stat st;
+        if (tr_fstatat(NULL, path, &st, 0) != 0 || !S_ISDIR(st.st_mode) ||
+            (uint64_t)st.st_ino != r->fp.inode)
+            continue;
+
+        // The registration below reads /user/app/<TITLE>, which has to be
+        // this folder's copy and not one left by another install
+        char name[32];
+        snprintf(name, sizeof(name), "%s/sce_sys", title_id);
+        if (tr_fstatat(&g_user_app, name, &st, 0) != 0 || !S_ISDIR(st.st_mode))
+            continue;
+        if (read_mount_lnk(title_id, linked, sizeof(linked)) != 0 || strcmp(linked, path) != 0)
+            continue;
+
+        tr_mkdirat(&g_system_ex_app, title_id, 0755);
+        if (mount_nullfs(path, system_ex_app) != 0) {
+            log_at(LOG_WARN, "  Cannot restore %s from %s (errno: %d)\n", title_id, path, errno);
+            continue;
+        }
+
+        pthread_mutex_lock(&register_lock);
+        double tr = trace_begin();
+        int reg = sceAppInstUtilAppInstallTitleDir(title_id, GM_ROOT "/user/app/", 0);
+        trace_end(TR_REGISTER, title_id, NULL, 0, reg, 0, 0, tr);
+        pthread_mutex_unlock(&register_lock);
+
+        // Left unmounted so the scan installs it from scratch
+        if (reg) {
+            unmount_path(system_ex_app, 0);
+            log_at(LOG_WARN, "  Cannot re-register %s, leaving it to the scan\n", title_id);
+            continue;
         }
+        log_msg("  [OK] Restored %s [%s] (%s)\n", cache_string(r->name_off),
+                get_game_region(title_id), title_id);
+        restored++;
     }
-    
-    // Other formats
-    if (strncmp(title_id, "NPXS", 4) == 0) return "System";
-    if (strncmp(title_id, "NPWR", 4) == 0) return "World";
-    
-    return "Unknown";
+    free(order);
+    return restored;
 }
 
-// ---------------- GET GAME NAME ----------------
-static int get_game_name_from_json(const char* json_path, char* name, size_t size) {
-    FILE* f = fopen(json_path, "rb");
-    if (!f) return -1;
+static void* discovery_main(void* arg) {
+    double t = monotonic_ms();
+    discover_games((game_work_list_t*)arg);
+    timing_span(PH_DISCOVERY, -1, t);
+    return NULL;
+}
 
-    fseek(f, 0, SEEK_END);
-    long len = ftell(f);
-    fseek(f, 0, SEEK_SET);
+// ---------------- DEVICE SCHEDULER ----------------
+// Work is grouped into one queue per backing device (st_dev of the root), each
+// with its own concurrency limit. Workers pick round-robin among queues that
+// are below their limit, so a slow USB HDD only ever occupies its own slots
+// while internal storage and the M.2 drive keep draining.
+#define DEFAULT_WORKERS 4
+#define MAX_WORKERS 16
+#define DEVICE_LIMIT 4
+#define USB_DEVICE_LIMIT 2
 
-    if (len <= 0 || len > 1024 * 1024) {
-        fclose(f);
-        return -1;
+static int g_num_workers = DEFAULT_WORKERS;
+static int g_usb_limit = USB_DEVICE_LIMIT;
+
+typedef struct {
+    uint64_t dev;
+    int root_idx;       // first root seen on this device, used as its label
+    int limit;
+    int* items;         // indices into the work list
+    int count;
+    int next;
+    int active;
+    // stats
+    int done;
+    double busy_ms;
+    double max_ms;
+    double first_start_ms;
+    double last_end_ms;
+} device_queue_t;
+
+typedef struct {
+    game_work_list_t* list;
+    device_queue_t queues[NUM_GAME_PATHS];
+    int num_queues;
+    int rr;             // round-robin cursor
+    int started;        // progress counter shown in logs and notifications
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} scheduler_t;
+
+static int scheduler_build(scheduler_t* s, game_work_list_t* list, int workers) {
+    memset(s->queues, 0, sizeof(s->queues));
+    s->list = list;
+    s->num_queues = 0;
+    s->rr = 0;
+    s->started = 0;
+
+    for (int i = 0; i < list->count; i++) {
+        const game_work_t* w = &list->items[i];
+        uint64_t dev = list->root_dev[w->root_idx];
+
+        device_queue_t* q = NULL;
+        for (int k = 0; k < s->num_queues; k++) {
+            if (s->queues[k].dev == dev) {
+                q = &s->queues[k];
+                break;
+            }
+        }
+        if (!q) {
+            q = &s->queues[s->num_queues++];
+            q->dev = dev;
+            q->root_idx = w->root_idx;
+            q->limit = !strncmp(GAME_PATHS[w->root_idx], GM_ROOT "/mnt/usb", strlen(GM_ROOT "/mnt/usb")) ? g_usb_limit : DEVICE_LIMIT;
+            q->items = (int*)malloc(list->count * sizeof(int));
+            if (!q->items) return -1;
+        }
+        q->items[q->count++] = i;
     }
 
-    char* buf = (char*)malloc(len + 1);
-    if (!buf) { fclose(f); return -1; }
+    // Leave at least one worker for the other devices
+    for (int k = 0; k < s->num_queues; k++) {
+        device_queue_t* q = &s->queues[k];
+        if (s->num_queues > 1 && q->limit > workers - 1)
+            q->limit = (workers > 1) ? workers - 1 : 1;
+        if (q->limit < 1)
+            q->limit = 1;
+    }
+    return 0;
+}
 
-    fread(buf, 1, len, f);
-    buf[len] = '\0';
-    fclose(f);
+static void scheduler_free(scheduler_t* s) {
+    for (int k = 0; k < s->num_queues; k++)
+        free(s->queues[k].items);
+    s->num_queues = 0;
+}
 
-    // Try multiple approaches to find the game name
-    
-    // 1. Try contentName (most common)
-    if (extract_json_string(buf, "contentName", name, size) == 0) {
-        name[strcspn(name, "\r\n")] = '\0';
-        free(buf);
-        return 0;
+// Returns the claimed work index, or -1 once every queue is drained
+static int scheduler_claim(scheduler_t* s, int* queue_out) {
+    pthread_mutex_lock(&s->lock);
+    for (;;) {
+        int pending = 0;
+        for (int n = 0; n < s->num_queues; n++) {
+            int k = (s->rr + n) % s->num_queues;
+            device_queue_t* q = &s->queues[k];
+            if (q->next >= q->count)
+                continue;
+            pending = 1;
+            if (q->active >= q->limit)
+                continue;
+
+            int idx = q->items[q->next++];
+            if (q->active++ == 0 && q->done == 0 && q->first_start_ms == 0)
+                q->first_start_ms = monotonic_ms();
+            s->rr = k + 1;
+            *queue_out = k;
+            pthread_mutex_unlock(&s->lock);
+            return idx;
+        }
+        if (!pending) {
+            pthread_mutex_unlock(&s->lock);
+            return -1;
+        }
+        pthread_cond_wait(&s->cond, &s->lock);
     }
-    
-    // 2. Try titleName at root level
-    if (extract_json_string(buf, "titleName", name, size) == 0) {
-        name[strcspn(name, "\r\n")] = '\0';
-        free(buf);
+}
+
+static void scheduler_complete(scheduler_t* s, int k, double elapsed_ms) {
+    pthread_mutex_lock(&s->lock);
+    device_queue_t* q = &s->queues[k];
+    q->active--;
+    q->done++;
+    q->busy_ms += elapsed_ms;
+    if (elapsed_ms > q->max_ms)
+        q->max_ms = elapsed_ms;
+    q->last_end_ms = monotonic_ms();
+    pthread_cond_broadcast(&s->cond);
+    pthread_mutex_unlock(&s->lock);
+}
+
+static void* worker_main(void* arg) {
+    scheduler_t* s = (scheduler_t*)arg;
+    int k;
+    int idx;
+
+    while ((idx = scheduler_claim(s, &k)) >= 0) {
+        game_work_t* w = &s->list->items[idx];
+        int current = __atomic_add_fetch(&s->started, 1, __ATOMIC_RELAXED);
+        double t0 = monotonic_ms();
+
+        char name[300] = "";
+        log_block_begin();
+        w->result = process_game(w, name, sizeof(name), current, s->list->count);
+        log_block_end();
+        if (name[0]) w->name = intern(name);
+
+        scheduler_complete(s, k, timing_span(PH_GAME, w->root_idx, t0) - t0);
+    }
+    copy_buffer_release();
+    return NULL;
+}
+
+static void log_device_stats(const device_queue_t* queues, int num_queues) {
+    for (int k = 0; k < num_queues; k++) {
+        const device_queue_t* q = &queues[k];
+        double wall_ms = q->last_end_ms - q->first_start_ms;
+        log_msg("    %s (dev %llx, limit %d): %d game(s) in %.2fs, %.1f games/s, avg %.0f ms, max %.0f ms\n",
+                GAME_PATHS[q->root_idx], (unsigned long long)q->dev, q->limit, q->done,
+                wall_ms / 1000.0, wall_ms > 0 ? q->done * 1000.0 / wall_ms : 0.0,
+                q->done ? q->busy_ms / q->done : 0.0, q->max_ms);
+    }
+}
+
+// Per-device stats are copied to stats_out (NUM_GAME_PATHS entries) for the summary
+static int run_worker_pool(game_work_list_t* list, int workers, device_queue_t* stats_out) {
+    scheduler_t s;
+    pthread_mutex_init(&s.lock, NULL);
+    pthread_cond_init(&s.cond, NULL);
+
+    if (workers > list->count) workers = list->count;
+    if (workers > MAX_WORKERS) workers = MAX_WORKERS;
+    if (workers < 1) workers = 1;
+
+    if (scheduler_build(&s, list, workers) != 0) {
+        log_at(LOG_ERROR, "  Out of memory while building device queues\n");
+        scheduler_free(&s);
         return 0;
     }
-    
-    // 3. Try to find titleName anywhere in the JSON
-    const char* title_search = strstr(buf, "\"titleName\"");
-    if (title_search) {
-        const char* colon = strchr(title_search, ':');
-        if (colon) {
-            colon++;
-            while (*colon == ' ' || *colon == '\t' || *colon == '\n' || *colon == '\r') colon++;
-            if (*colon == '\"') {
-                colon++;
-                const char* end_quote = strchr(colon, '\"');
-                if (end_quote && (end_quote - colon) < (long)size) {
-                    memcpy(name, colon, end_quote - colon);
-                    name[end_quote - colon] = '\0';
-                    free(buf);
-                    return 0;
-                }
+
+    pthread_t threads[MAX_WORKERS];
+    int started = 0;
+    for (int i = 1; i < workers; i++) {
+        if (pthread_create(&threads[started], NULL, worker_main, &s) != 0) {
+            log_at(LOG_WARN, "  Could not start worker %d (errno: %d)\n", i, errno);
+            break;
+        }
+        started++;
+    }
+
+    // The calling thread is always one of the workers
+    worker_main(&s);
+
+    for (int i = 0; i < started; i++)
+        pthread_join(threads[i], NULL);
+
+    int num_queues = s.num_queues;
+    for (int k = 0; k < num_queues; k++) {
+        stats_out[k] = s.queues[k];
+        stats_out[k].items = NULL;
+    }
+    scheduler_free(&s);
+    pthread_cond_destroy(&s.cond);
+    pthread_mutex_destroy(&s.lock);
+    return num_queues;
+}
+
+// ---------------- AUTO UNMOUNT DELETED GAMES ----------------
+// Mounted titles are checked against the set of game folders discovery just
+// found, so a title costs one mount.lnk read instead of a stat per
+// GAME_PATHS root. Unmounts are issued as one batch and confirmed by polling
+// the mount state instead of sleeping a fixed 100 ms after each.
+#define UNMOUNT_WAIT_MS 2000
+#define UNMOUNT_POLL_MS 5
+
+// Unmounts the titles, then hands their /user/app and /user/appmeta entries
+// to the background deleter
+static int cleanup_titles(char (*titles)[12], int count) {
+    char path[PATH_MAX];
+    if (count <= 0) return 0;
+
+    char* waiting = (char*)calloc(count, 1);
+
+    for (int i = 0; i < count; i++) {
+        snprintf(path, sizeof(path), GM_ROOT "/system_ex/app/%s", titles[i]);
+        log_msg("  [CLEANUP] Unmounting deleted game: %s\n", titles[i]);
+
+        if (!is_mounted(path)) continue;
+        if (unmount_path(path, 0) != 0) {
+            log_at(LOG_WARN, "  Normal unmount failed for %s, forcing...\n", titles[i]);
+            if (unmount_path(path, MNT_FORCE) != 0) {
+                log_at(LOG_ERROR, "  Force unmount failed for %s (errno: %d)\n", titles[i], errno);
+                continue;
             }
         }
+        if (waiting) waiting[i] = 1;
     }
 
-    free(buf);
-    return -1;
+    // Wait until the mount table no longer lists any of them
+    double deadline = monotonic_ms() + UNMOUNT_WAIT_MS;
+    int left = 0;
+    while (waiting) {
+        left = 0;
+        for (int i = 0; i < count; i++) {
+            if (!waiting[i]) continue;
+            snprintf(path, sizeof(path), GM_ROOT "/system_ex/app/%s", titles[i]);
+            if (is_mounted_live(path)) left++;
+            else waiting[i] = 0;
+        }
+        if (left == 0 || monotonic_ms() >= deadline) break;
+        usleep(UNMOUNT_POLL_MS * 1000);
+    }
+    if (left > 0)
+        log_at(LOG_WARN, "  %d title(s) still mounted after %d ms\n", left, UNMOUNT_WAIT_MS);
+    free(waiting);
+
+    for (int i = 0; i < count; i++) {
+        delete_tree_async(&g_user_app, titles[i]);
+        delete_tree_async(&g_user_appmeta, titles[i]);
+
+        log_msg("  [OK] Cleaned up %s\n", titles[i]);
+    }
+    return count;
 }
 
-// ---------------- CACHE SYSTEM ----------------
-typedef struct {
-    char title_id[12];
-    char name[256];
+// mount.lnk sources under a fully listed GAME_PATHS root are answered by the
+// set (a root that is gone contributes nothing); anything else, including a
+// root whose listing stopped early, still needs a stat
+static int source_present(const path_set_t* present, const char* game_path) {
+    for (int i = 0; i < (int)NUM_GAME_PATHS; i++) {
+        size_t n = strlen(GAME_PATHS[i]);
+        if (!strncmp(game_path, GAME_PATHS[i], n) && game_path[n] == '/') {
+            if (!present->partial[i])
+                return path_set_has(present, game_path);
+            break;
+        }
+    }
+
+    struct stat st;
+    return tr_fstatat(NULL, game_path, &st, 0) == 0 && S_ISDIR(st.st_mode);
+}
+
+// A cleaned title is registered under its last known source folder
+static void record_cleaned(const char* title_id, const char* game_path) {
+    const cache_record_t* cached = cache_find_title(title_id);
     char path[PATH_MAX];
-    time_t last_seen;
-    long size;
-} game_cache_entry_t;
+    if (game_path[0])
+        snprintf(path, sizeof(path), "%s", game_path);
+    else if (cached)
+        snprintf(path, sizeof(path), "%s", cache_string(cached->path_off));
+    else
+        snprintf(path, sizeof(path), GM_ROOT "/system_ex/app/%s", title_id);
+    record_game(title_id, cached ? cache_string(cached->name_off) : title_id, path, NULL, 0, GAME_CLEANED);
+}
 
-static int load_cache(game_cache_entry_t** entries, int* count) {
-    FILE* f = fopen(CACHE_FILE, "r");
-    if (!f) {
-        *entries = NULL;
-        *count = 0;
-        return 0;
+static int auto_unmount_deleted_games(const path_set_t* present) {
+    // Scan /system_ex/app/ to find ALL games (mounted and native)
+    DIR* d = dir_list(&g_system_ex_app);
+    if (!d) return 0;
+
+    char (*stale)[12] = NULL;
+    int num_stale = 0, cap = 0;
+    struct dirent* e;
+
+    while ((e = readdir(d))) {
+        if (!strcmp(e->d_name, ".") || !strcmp(e->d_name, ".."))
+            continue;
+
+        // Check if this looks like a title ID (CUSA/PPSA format)
+        if ((strncmp(e->d_name, "CUSA", 4) != 0 && 
+             strncmp(e->d_name, "PPSA", 4) != 0) || 
+            strlen(e->d_name) != 9) {
+            continue;
+        }
+
+        char path[PATH_MAX];
+        char game_path[PATH_MAX] = {};
+        int should_unmount = 0;
+
+        if (read_mount_lnk(e->d_name, game_path, sizeof(game_path)) == 0) {
+            should_unmount = !source_present(present, game_path);
+        } else {
+            // No mount.lnk: older installs keep the source at <root>/<TITLE>-app.
+            // The folder may be in any root, so a partial listing can't rule it out.
+            char app_name[sizeof(e->d_name) + 4];
+            snprintf(app_name, sizeof(app_name), "%s-app", e->d_name);
+            if (!present->any_partial && !path_set_has(present, app_name)) {
+                // A mounted game if it has our sce_sys copy or a nullfs mount
+                struct stat st;
+                snprintf(path, sizeof(path), "%s/sce_sys", e->d_name);
+                if (tr_fstatat(&g_user_app, path, &st, 0) == 0 && S_ISDIR(st.st_mode)) {
+                    should_unmount = 1;
+                } else {
+                    snprintf(path, sizeof(path), GM_ROOT "/system_ex/app/%s", e->d_name);
+                    should_unmount = is_mounted(path);
+                }
+            }
+        }
+
+        if (!should_unmount)
+            continue;
+
+        // Recorded as cleaned only once it is sure to be cleaned up
+        if (num_stale == cap) {
+            int new_cap = cap ? cap * 2 : 16;
+            char (*grown)[12] = (char (*)[12])realloc(stale, new_cap * sizeof(*stale));
+            if (!grown) {
+                log_at(LOG_WARN, "  Out of memory, %s is left for the next run\n", e->d_name);
+                continue;
+            }
+            stale = grown;
+            cap = new_cap;
+        }
+        memcpy(stale[num_stale++], e->d_name, 10);  // 9 characters, checked above
+        record_cleaned(e->d_name, game_path);
     }
-    
-    fseek(f, 0, SEEK_END);
-    long len = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    
-    if (len <= 0 || len > 10 * 1024 * 1024) {
-        fclose(f);
+
+    closedir(d);
+
+    int unmounted = cleanup_titles(stale, num_stale);
+    free(stale);
+    return unmounted;
+}
+
+// ---------------- TIMING REPORT ----------------
+static void timing_json_hist(FILE* f, const char* label, const timing_hist_t* h) {
+    fprintf(f, "\"%s\":{\"count\":%llu,\"total_ms\":%.3f,\"p50_ms\":%.3f,\"p95_ms\":%.3f,\"max_ms\":%.3f}",
+            label, (unsigned long long)h->count, h->total_ms,
+            timing_percentile(h, 0.50), timing_percentile(h, 0.95), h->max_ms);
+}
+
+// Appends this run to TIMING_FILE, dropping the oldest beyond TIMING_HISTORY.
+// Each run is one line inside "runs", so earlier ones are carried over
+// verbatim without a JSON parser.
+static int timing_write_report(const char* mode, double elapsed_ms) {
+    char* old = NULL;
+    size_t old_len = 0;
+    const char* lines[TIMING_HISTORY];
+    size_t line_len[TIMING_HISTORY];
+    int kept = 0;
+
+    old = read_small_file(NULL, TIMING_FILE, 1024 * 1024, &old_len);
+    if (old) {
+        for (char* p = old; p && *p; ) {
+            char* end = strchr(p, '\n');
+            size_t n = end ? (size_t)(end - p) : strlen(p);
+            if (n > 0 && p[n - 1] == ',') n--;
+            if (!strncmp(p, "{\"started\":", 11)) {
+                // Oldest runs are first; keep room for this one
+                if (kept == TIMING_HISTORY - 1) {
+                    memmove(lines, lines + 1, (kept - 1) * sizeof(lines[0]));
+                    memmove(line_len, line_len + 1, (kept - 1) * sizeof(line_len[0]));
+                    kept--;
+                }
+                lines[kept] = p;
+                line_len[kept++] = n;
+            }
+            p = end ? end + 1 : NULL;
+        }
+    }
+
+    char tmp_path[PATH_MAX];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", TIMING_FILE);
+    FILE* f = fopen(tmp_path, "w");
+    if (!f) {
+        free(old);
         return -1;
     }
-    
-    char* buf = (char*)malloc(len + 1);
-    if (!buf) {
+
+    fprintf(f, "{\"version\":1,\"runs\":[\n");
+    for (int i = 0; i < kept; i++) {
+        fwrite(lines[i], 1, line_len[i], f);
+        fprintf(f, ",\n");
+    }
+    free(old);
+
+    pthread_mutex_lock(&g_timing.lock);
+    fprintf(f, "{\"started\":%lld,\"mode\":\"%s\",\"elapsed_ms\":%.3f,\"phases\":{",
+            (long long)(time(NULL) - (time_t)(elapsed_ms / 1000.0)), mode, elapsed_ms);
+    int first = 1;
+    for (int p = 0; p < PH_COUNT; p++) {
+        const timing_hist_t* all = &g_timing.hist[p][TIMING_ALL];
+        if (all->count == 0) continue;
+        fprintf(f, "%s\"%s\":{", first ? "" : ",", PHASE_NAMES[p]);
+        first = 0;
+        timing_json_hist(f, "all", all);
+        for (int d = 0; d < (int)NUM_GAME_PATHS; d++) {
+            if (g_timing.hist[p][d].count == 0) continue;
+            fputc(',', f);
+            timing_json_hist(f, LOCATION_NAMES[d], &g_timing.hist[p][d]);
+        }
+        fputc('}', f);
+    }
+    pthread_mutex_unlock(&g_timing.lock);
+    fprintf(f, "}}\n]}\n");
+
+    if (fflush(f) != 0 || fsync(fileno(f)) != 0) {
         fclose(f);
+        unlink(tmp_path);
         return -1;
     }
-    
-    fread(buf, 1, len, f);
-    buf[len] = '\0';
     fclose(f);
-    
-    // Simple JSON parsing - count entries
-    int entry_count = 0;
-    char* p = buf;
-    while ((p = strstr(p, "\"title_id\""))) {
-        entry_count++;
-        p++;
+    return rename(tmp_path, TIMING_FILE);
+}
+
+static void timing_log_summary(void) {
+    pthread_mutex_lock(&g_timing.lock);
+    for (int p = 0; p < PH_COUNT; p++) {
+        const timing_hist_t* h = &g_timing.hist[p][TIMING_ALL];
+        if (h->count == 0) continue;
+        log_msg("    %-10s %5llu span(s), total %8.1f ms, p50 %7.2f ms, p95 %7.2f ms, max %7.2f ms\n",
+                PHASE_NAMES[p], (unsigned long long)h->count, h->total_ms,
+                timing_percentile(h, 0.50), timing_percentile(h, 0.95), h->max_ms);
     }
-    
-    if (entry_count == 0) {
-        free(buf);
-        *entries = NULL;
-        *count = 0;
+    pthread_mutex_unlock(&g_timing.lock);
+}
+
+// ---------------- DAEMON MODE ----------------
+// --daemon keeps the payload resident after the initial scan. Every
+// GAME_PATHS root, every game folder and every game's sce_sys is watched
+// (kqueue EVFILT_VNODE on the console, inotify in the Linux host build). An
+// event only marks the affected game pending; a pending game is processed,
+// or cleaned up if its folder is gone, once it has been quiet for
+// DAEMON_SETTLE_MS and its top-level size/mtime signature has stopped
+// changing, so a copy still in progress isn't mounted half-written.
+//
+// The roots themselves are polled as devices: when /mnt/usbN or /mnt/ext0
+// appears (or comes back on another device) only that root is scanned, and
+// when it goes away only its titles are unmounted.
+#define DAEMON_SETTLE_MS 3000
+#define DAEMON_TICK_MS   500
+#define DEVICE_POLL_MS   1000
+
+enum { WATCH_ROOT, WATCH_GAME, WATCH_SCE_SYS };
+
+typedef struct {
+    int id;            // kqueue: open directory fd, inotify: watch descriptor
+    int kind;          // WATCH_*
+    int target;        // root index for WATCH_ROOT, else daemon game index
+} watch_t;
+
+typedef struct {
+    int fd;            // kqueue or inotify instance
+    watch_t* items;    // slots with id < 0 are free
+    int count;
+    int capacity;
+    int overflowed;    // events were lost since the last wait
+} watcher_t;
+
+typedef struct {
+    char* path;        // NULL for a free slot
+    int root_idx;
+    int game_watch;
+    int sys_watch;
+    int seen;          // still listed by the last rescan of its root
+    int pending;
+    double due_ms;
+    uint64_t signature;
+    uint64_t processed;   // signature after our own last pass (DRM patch, ...)
+} daemon_game_t;
+
+typedef struct {
+    watcher_t watcher;
+    daemon_game_t* games;
+    int count;
+    int capacity;
+    uint32_t* index;   // path hash -> game index + 1, 0 meaning empty
+    uint32_t index_slots;
+    int root_watch[NUM_GAME_PATHS];
+    int root_present[NUM_GAME_PATHS];
+    uint64_t root_dev[NUM_GAME_PATHS];
+} daemon_t;
+
+static volatile sig_atomic_t g_daemon_stop = 0;
+
+static void daemon_signal(int sig) {
+    (void)sig;
+    g_daemon_stop = 1;
+}
+
+static int watcher_open(watcher_t* w) {
+    memset(w, 0, sizeof(*w));
+#ifdef __linux__
+    w->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#else
+    w->fd = kqueue();
+#endif
+    return w->fd < 0 ? -1 : 0;
+}
+
+// Returns the watch slot, or -1 if the directory can't be watched
+static int watcher_add(watcher_t* w, const char* path, int kind, int target) {
+    int slot = 0;
+    while (slot < w->count && w->items[slot].id >= 0)
+        slot++;
+    if (slot == w->count) {
+        if (w->count == w->capacity) {
+            int cap = w->capacity ? w->capacity * 2 : 64;
+            watch_t* items = (watch_t*)realloc(w->items, cap * sizeof(watch_t));
+            if (!items) return -1;
+            w->items = items;
+            w->capacity = cap;
+        }
+        w->count++;
+    }
+
+#ifdef __linux__
+    int id = inotify_add_watch(w->fd, path, IN_CREATE | IN_DELETE | IN_MOVED_FROM |
+                               IN_MOVED_TO | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |
+                               IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+#else
+    int id = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (id >= 0) {
+        struct kevent kev;
+        EV_SET(&kev, id, EVFILT_VNODE, EV_ADD | EV_CLEAR,
+               NOTE_WRITE | NOTE_EXTEND | NOTE_ATTRIB | NOTE_DELETE |
+               NOTE_RENAME | NOTE_REVOKE, 0, (void*)(intptr_t)slot);
+        if (kevent(w->fd, &kev, 1, NULL, 0, NULL) != 0) {
+            close(id);
+            id = -1;
+        }
+    }
+#endif
+    w->items[slot].id = id;
+    if (id < 0) return -1;
+    w->items[slot].kind = kind;
+    w->items[slot].target = target;
+    return slot;
+}
+
+static void watcher_remove(watcher_t* w, int slot) {
+    if (slot < 0 || slot >= w->count || w->items[slot].id < 0) return;
+#ifdef __linux__
+    inotify_rm_watch(w->fd, w->items[slot].id);
+#else
+    close(w->items[slot].id);   // closing the fd drops its kevent
+#endif
+    w->items[slot].id = -1;
+}
+
+static void watcher_close(watcher_t* w) {
+    for (int i = 0; i < w->count; i++)
+        watcher_remove(w, i);
+    if (w->fd >= 0) close(w->fd);
+    free(w->items);
+    memset(w, 0, sizeof(*w));
+}
+
+// Waits up to timeout_ms and stores the slots that fired; returns their count.
+// Sets w->overflowed if events were dropped (kernel queue overflow, or more
+// than max slots fired), after which nothing short of a rescan is reliable.
+static int watcher_wait(watcher_t* w, int timeout_ms, int* slots, int max) {
+    int n = 0;
+    w->overflowed = 0;
+#ifdef __linux__
+    struct pollfd pfd = { w->fd, POLLIN, 0 };
+    if (poll(&pfd, 1, timeout_ms) <= 0)
         return 0;
+
+    char buf[16384] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t len;
+    while ((len = read(w->fd, buf, sizeof(buf))) > 0) {
+        for (char* p = buf; p < buf + len; ) {
+            const struct inotify_event* ev = (const struct inotify_event*)p;
+            p += sizeof(*ev) + ev->len;
+            if (ev->mask & IN_Q_OVERFLOW) w->overflowed = 1;
+            if (ev->mask & (IN_IGNORED | IN_Q_OVERFLOW)) continue;
+            if (n == max) {
+                w->overflowed = 1;
+                continue;
+            }
+            for (int i = 0; i < w->count; i++) {
+                if (w->items[i].id == ev->wd) {
+                    slots[n++] = i;
+                    break;
+                }
+            }
+        }
     }
-    
-    *entries = (game_cache_entry_t*)calloc(entry_count, sizeof(game_cache_entry_t));
-    if (!*entries) {
-        free(buf);
-        return -1;
+#else
+    struct kevent evs[64];
+    struct timespec ts = { timeout_ms / 1000, (timeout_ms % 1000) * 1000000L };
+    int got = kevent(w->fd, NULL, 0, evs, max < 64 ? max : 64, &ts);
+    for (int i = 0; i < got; i++) {
+        int slot = (int)(intptr_t)evs[i].udata;
+        if (slot >= 0 && slot < w->count && w->items[slot].id == (int)evs[i].ident)
+            slots[n++] = slot;
     }
-    
-    // Parse entries (simplified)
-    *count = entry_count;
-    free(buf);
-    return 0;
+#endif
+    return n;
 }
 
-static int save_cache(game_cache_entry_t* entries, int count) {
-    FILE* f = fopen(CACHE_FILE, "w");
-    if (!f) return -1;
-    
-    fprintf(f, "{\n  \"games\": [\n");
-    
-    for (int i = 0; i < count; i++) {
-        if (entries[i].title_id[0] == '\0') continue;
-        fprintf(f, "    {\n");
-        fprintf(f, "      \"title_id\": \"%s\",\n", entries[i].title_id);
-        fprintf(f, "      \"name\": \"%s\",\n", entries[i].name);
-        fprintf(f, "      \"path\": \"%s\",\n", entries[i].path);
-        fprintf(f, "      \"last_seen\": %ld\n", entries[i].last_seen);
-        fprintf(f, "    }%s\n", (i < count - 1) ? "," : "");
+// Entry count, total size and newest mtime of a folder's direct entries
+static uint64_t dir_signature(const char* path) {
+    DIR* d = opendir(path);
+    if (!d) return 0;
+
+    uint64_t count = 0, bytes = 0;
+    int64_t newest = 0;
+    struct dirent* e;
+    struct stat st;
+    while ((e = readdir(d))) {
+        if (!strcmp(e->d_name, ".") || !strcmp(e->d_name, ".."))
+            continue;
+        if (fstatat(dirfd(d), e->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+            continue;
+        count++;
+        bytes += (uint64_t)st.st_size;
+        if ((int64_t)st.st_mtime > newest) newest = (int64_t)st.st_mtime;
     }
-    
-    fprintf(f, "  ]\n}\n");
-    fclose(f);
+    closedir(d);
+
+    return (count * 0x9E3779B97F4A7C15ULL) ^ (bytes * 0xC2B2AE3D27D4EB4FULL) ^ (uint64_t)newest;
+}
+
+static uint64_t game_signature(const char* game_path) {
+    char sce_sys[PATH_MAX];
+    snprintf(sce_sys, sizeof(sce_sys), "%s/sce_sys", game_path);
+    uint64_t sys = dir_signature(sce_sys);
+    return dir_signature(game_path) ^ ((sys << 31) | (sys >> 33));
+}
+
+static void daemon_mark(daemon_t* dm, int idx) {
+    daemon_game_t* g = &dm->games[idx];
+    g->pending = 1;
+    g->due_ms = monotonic_ms() + DAEMON_SETTLE_MS;
+}
+
+// sce_sys usually appears after its game folder while a copy is running
+static void daemon_watch_sce_sys(daemon_t* dm, int idx) {
+    daemon_game_t* g = &dm->games[idx];
+    if (g->sys_watch >= 0) return;
+
+    char sce_sys[PATH_MAX];
+    snprintf(sce_sys, sizeof(sce_sys), "%s/sce_sys", g->path);
+    g->sys_watch = watcher_add(&dm->watcher, sce_sys, WATCH_SCE_SYS, idx);
+}
+
+static int daemon_find_game(daemon_t* dm, const char* path) {
+    if (!dm->index) return -1;
+    uint32_t mask = dm->index_slots - 1;
+    for (uint32_t i = cache_hash(path) & mask; dm->index[i]; i = (i + 1) & mask) {
+        int idx = (int)dm->index[i] - 1;
+        if (!strcmp(dm->games[idx].path, path)) return idx;
+    }
+    return -1;
+}
+
+static void daemon_index_insert(uint32_t* index, uint32_t slots, const char* path, int idx) {
+    uint32_t i = cache_hash(path) & (slots - 1);
+    while (index[i])
+        i = (i + 1) & (slots - 1);
+    index[i] = (uint32_t)idx + 1;
+}
+
+// Room for one more game; dm->count bounds the live ones
+static int daemon_index_reserve(daemon_t* dm) {
+    if ((uint32_t)(dm->count + 1) * 2 <= dm->index_slots)
+        return 0;
+    uint32_t slots = dm->index_slots ? dm->index_slots * 2 : 128;
+    uint32_t* index = (uint32_t*)calloc(slots, sizeof(uint32_t));
+    if (!index) return -1;
+    for (int i = 0; i < dm->count; i++)
+        if (dm->games[i].path)
+            daemon_index_insert(index, slots, dm->games[i].path, i);
+    free(dm->index);
+    dm->index = index;
+    dm->index_slots = slots;
     return 0;
 }
 
-// ---------------- GET TITLE_ID ----------------
-static int get_title_id_from_dir(const char* game_dir, char* title_id, size_t size) {
-    char path[PATH_MAX];
+// Backward-shift delete, so probe runs stay unbroken without tombstones
+static void daemon_index_remove(daemon_t* dm, int idx) {
+    uint32_t mask = dm->index_slots - 1;
+    uint32_t hole = cache_hash(dm->games[idx].path) & mask;
+    while (dm->index[hole] && (int)dm->index[hole] - 1 != idx)
+        hole = (hole + 1) & mask;
+    if (!dm->index[hole]) return;
+
+    for (uint32_t i = (hole + 1) & mask; dm->index[i]; i = (i + 1) & mask) {
+        uint32_t home = cache_hash(dm->games[dm->index[i] - 1].path) & mask;
+        // The entry may move into the hole if the hole is on its probe path
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            dm->index[hole] = dm->index[i];
+            hole = i;
+        }
+    }
+    dm->index[hole] = 0;
+}
+
+static int daemon_add_game(daemon_t* dm, const char* path, int root_idx) {
+    if (daemon_index_reserve(dm) != 0) return -1;
+    int idx = 0;
+    while (idx < dm->count && dm->games[idx].path)
+        idx++;
+    if (idx == dm->count) {
+        if (dm->count == dm->capacity) {
+            int cap = dm->capacity ? dm->capacity * 2 : 64;
+            daemon_game_t* games = (daemon_game_t*)realloc(dm->games, cap * sizeof(daemon_game_t));
+            if (!games) return -1;
+            dm->games = games;
+            dm->capacity = cap;
+        }
+        dm->count++;
+    }
+
+    daemon_game_t* g = &dm->games[idx];
+    memset(g, 0, sizeof(*g));
+    g->path = strdup(path);
+    if (!g->path) return -1;
+    daemon_index_insert(dm->index, dm->index_slots, g->path, idx);
+    g->root_idx = root_idx;
+    g->seen = 1;
+    g->game_watch = watcher_add(&dm->watcher, path, WATCH_GAME, idx);
+    g->sys_watch = -1;
+    daemon_watch_sce_sys(dm, idx);
+    return idx;
+}
+
+static void daemon_remove_game(daemon_t* dm, int idx) {
+    daemon_game_t* g = &dm->games[idx];
+    watcher_remove(&dm->watcher, g->game_watch);
+    watcher_remove(&dm->watcher, g->sys_watch);
+    daemon_index_remove(dm, idx);
+    free(g->path);
+    g->path = NULL;
+}
+
+// Diffs a root's listing against the known games: new folders become
+// pending, vanished ones are marked for cleanup
+static void daemon_rescan_root(daemon_t* dm, int root_idx, int quiet) {
+    for (int i = 0; i < dm->count; i++)
+        if (dm->games[i].path && dm->games[i].root_idx == root_idx)
+            dm->games[i].seen = 0;
+
+    // Reopened, in case the root folder itself was replaced
+    dir_t* root = &g_roots[root_idx];
+    dir_close(root);
+    DIR* d = dir_open(root, NULL, GAME_PATHS[root_idx]) == 0 ? dir_list(root) : NULL;
+    if (d) {
+        struct dirent* e;
+        while ((e = readdir(d))) {
+            if (!strcmp(e->d_name, ".") || !strcmp(e->d_name, ".."))
+                continue;
+            if (e->d_type != DT_DIR && e->d_type != DT_UNKNOWN && e->d_type != DT_LNK)
+                continue;
+
+            char game_path[PATH_MAX];
+            snprintf(game_path, sizeof(game_path), "%s/%s", GAME_PATHS[root_idx], e->d_name);
 
-    snprintf(path, sizeof(path), "%s/sce_sys/param.json", game_dir);
-    FILE* f = fopen(path, "rb");
-    if (f) {
-        fseek(f, 0, SEEK_END);
-        long len = ftell(f);
-        fseek(f, 0, SEEK_SET);
-
-        if (len > 0 && len < 1024 * 1024) {
-            char* buf = (char*)malloc(len + 1);
-            if (buf) {
-                fread(buf, 1, len, f);
-                buf[len] = '\0';
-
-                if (extract_json_string(buf, "titleId", title_id, size) == 0 ||
-                    extract_json_string(buf, "title_id", title_id, size) == 0) {
-                    title_id[strcspn(title_id, "\r\n")] = '\0';
-                    free(buf);
-                    fclose(f);
-                    return 0;
-                }
-                free(buf);
+            int idx = daemon_find_game(dm, game_path);
+            if (idx >= 0) {
+                dm->games[idx].seen = 1;
+                continue;
+            }
+
+            struct stat st;
+            if (e->d_type != DT_DIR && (fstatat(root->fd, e->d_name, &st, 0) != 0 || !S_ISDIR(st.st_mode)))
+                continue;
+
+            idx = daemon_add_game(dm, game_path, root_idx);
+            if (idx >= 0) {
+                if (!quiet) log_msg("[DAEMON] New folder: %s\n", game_path);
+                daemon_mark(dm, idx);
             }
         }
-        fclose(f);
+        closedir(d);
     }
 
-    snprintf(path, sizeof(path), "%s/sce_sys/param.sfo", game_dir);
-    return read_title_id_from_sfo(path, title_id, size);
+    for (int i = 0; i < dm->count; i++)
+        if (dm->games[i].path && dm->games[i].root_idx == root_idx && !dm->games[i].seen)
+            daemon_mark(dm, i);
 }
 
-// ---------------- PATCH DRM (PS5 only) ----------------
-static int fix_application_drm_type(const char* path) {
-    FILE* f = fopen(path, "rb");
-    if (!f) return -1;
+// Drops a vanished folder; returns 1 if its title (in title_id) is still
+// mounted from it and has to be cleaned up
+static int daemon_forget_game(daemon_t* dm, int idx, char* title_id) {
+    const char* path = dm->games[idx].path;
+    int cleanup = 0;
 
-    fseek(f, 0, SEEK_END);
-    long len = ftell(f);
-    fseek(f, 0, SEEK_SET);
+    title_id[0] = '\0';
+    if (forget_game(path, title_id, 12) == 0 && title_id[0]) {
+        char linked[PATH_MAX];
+        read_mount_lnk(title_id, linked, sizeof(linked));
 
-    if (len <= 0 || len > 1024 * 1024) {
-        fclose(f);
-        return -1;
+        // Another folder with the same title may have been mounted since
+        cleanup = !linked[0] || !strcmp(linked, path);
     }
 
-    char* buf = (char*)malloc(len + 1);
-    if (!buf) { fclose(f); return -1; }
+    log_msg("[DAEMON] Removed: %s\n", path);
+    daemon_remove_game(dm, idx);
+    return cleanup;
+}
 
-    fread(buf, 1, len, f);
-    buf[len] = '\0';
-    fclose(f);
+static void daemon_cleanup_game(daemon_t* dm, int idx) {
+    char title[1][12];
+    int root_idx = dm->games[idx].root_idx;
+    if (daemon_forget_game(dm, idx, title[0])) {
+        double t = monotonic_ms();
+        cleanup_titles(title, 1);
+        timing_span(PH_CLEANUP, root_idx, t);
+    }
+}
 
-    const char* key = "\"applicationDrmType\"";
-    char* p = strstr(buf, key);
-    if (!p) { free(buf); return 0; }
+static void daemon_process_game(daemon_t* dm, int idx) {
+    daemon_game_t* g = &dm->games[idx];
+    struct stat st;
 
-    char* colon = strchr(p + strlen(key), ':');
-    char* q1 = colon ? strchr(colon, '"') : NULL;
-    char* q2 = q1 ? strchr(q1 + 1, '"') : NULL;
-    if (!q1 || !q2) { free(buf); return -1; }
+    if (stat(g->path, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        daemon_cleanup_game(dm, idx);
+        return;
+    }
 
-    if ((q2 - q1 - 1) == strlen("standard") &&
-        !strncmp(q1 + 1, "standard", strlen("standard"))) {
-        free(buf);
-        return 0;
+    // Still being written: wait for another quiet period
+    daemon_watch_sce_sys(dm, idx);
+    uint64_t sig = game_signature(g->path);
+    if (sig != g->signature) {
+        g->signature = sig;
+        daemon_mark(dm, idx);
+        return;
     }
+    g->pending = 0;
 
-    size_t new_len = (q1 - buf) + 1 + strlen("standard") + 1 + strlen(q2 + 1);
-    char* out = (char*)malloc(new_len + 1);
-    if (!out) { free(buf); return -1; }
+    // The event came from our own writes to the folder
+    if (sig == g->processed)
+        return;
 
-    memcpy(out, buf, q1 - buf + 1);
-    memcpy(out + (q1 - buf + 1), "standard", strlen("standard"));
-    strcpy(out + (q1 - buf + 1 + strlen("standard")), q2);
+    game_work_t w = {};
+    char name[300] = "";
+    w.path = g->path;
+    w.root_idx = g->root_idx;
+    w.inode = (uint64_t)st.st_ino;
 
-    f = fopen(path, "wb");
-    if (!f) { free(buf); free(out); return -1; }
+    double t = monotonic_ms();
+    log_block_begin();
+    w.result = process_game(&w, name, sizeof(name), 1, 1);
+    log_block_end();
+    copy_buffer_release();
+    timing_span(PH_GAME, w.root_idx, t);
 
-    fwrite(out, 1, strlen(out), f);
-    fclose(f);
+    g = &dm->games[idx];
+    g->processed = g->signature = game_signature(g->path);
 
-    free(buf);
-    free(out);
+    if (w.result == 0)
+        notify_mounted(name);
+}
+
+// ---- device monitor ----
+static int root_device(int root_idx, uint64_t* dev) {
+    struct stat st;
+    if (stat(GAME_PATHS[root_idx], &st) != 0 || !S_ISDIR(st.st_mode))
+        return 0;
+    *dev = (uint64_t)st.st_dev;
     return 1;
 }
 
-// ---------------- CHECK IF ALREADY MOUNTED ----------------
-static int is_game_already_mounted(const char* title_id, const char* game_path) {
-    char mount_lnk_path[PATH_MAX];
-    char system_ex_app[PATH_MAX];
-    
-    // Check if mount.lnk exists and points to the same path
-    snprintf(mount_lnk_path, sizeof(mount_lnk_path), 
-             "/user/app/%s/mount.lnk", title_id);
-    
-    FILE* f = fopen(mount_lnk_path, "r");
-    if (f) {
-        char existing_path[PATH_MAX] = {};
-        if (fgets(existing_path, sizeof(existing_path), f)) {
-            // Remove newline if present
-            existing_path[strcspn(existing_path, "\r\n")] = '\0';
-            fclose(f);
-            
-            // Check if it's the same game path
-            if (strcmp(existing_path, game_path) == 0) {
-                // Also verify the nullfs mount is still active
-                snprintf(system_ex_app, sizeof(system_ex_app),
-                         "/system_ex/app/%s", title_id);
-                if (is_mounted(system_ex_app)) {
-                    return 1;  // Already mounted
-                }
-            }
-        } else {
-            fclose(f);
-        }
+// Unmounts every title of a root that went away, leaving other roots alone
+static void daemon_detach(daemon_t* dm, int root_idx) {
+    log_msg("\n[DEVICE] %s removed\n", GAME_PATHS[root_idx]);
+    watcher_remove(&dm->watcher, dm->root_watch[root_idx]);
+    dm->root_watch[root_idx] = -1;
+    dm->root_present[root_idx] = 0;
+    dir_close(&g_roots[root_idx]);
+
+    // Collect the titles first so they are unmounted as one batch
+    char (*titles)[12] = (char (*)[12])malloc((dm->count + 1) * sizeof(*titles));
+    int removed = 0, batch = 0;
+    for (int i = 0; i < dm->count; i++) {
+        if (!dm->games[i].path || dm->games[i].root_idx != root_idx)
+            continue;
+        char title_id[12];
+        if (daemon_forget_game(dm, i, title_id) && titles)
+            snprintf(titles[batch++], sizeof(titles[0]), "%s", title_id);
+        removed++;
     }
-    
-    return 0;  // Not mounted or different path
-}
+    double t = monotonic_ms();
+    cleanup_titles(titles, batch);
+    timing_span(PH_CLEANUP, root_idx, t);
+    free(titles);
 
-// Cache tracking for saving after scan
-static game_cache_entry_t g_found_games[256];
-static int g_found_count = 0;
+    // Folders that had failed or lost their title to another folder weren't mounted
+    log_msg("[DEVICE] %s: %d game(s) unmounted, %d folder(s) dropped\n", LOCATION_NAMES[root_idx],
+            batch, removed);
+    notify("%s removed\nUnmounted %d game(s)", LOCATION_NAMES[root_idx], batch);
+}
 
-// ---------------- PROCESS ONE GAME ----------------
-static int process_game(const char* game_path, char* game_name_out, size_t name_size, int current, int total) {
-    char title_id[12] = {};
-    char game_name[256] = "Unknown Game";
-    char system_ex_app[PATH_MAX];
-    char user_app_dir[PATH_MAX];
-    char src_sce_sys[PATH_MAX];
-    char mount_lnk_path[PATH_MAX];
-    char param_json_path[PATH_MAX];
+// Scans and mounts just the root that appeared
+static void daemon_attach(daemon_t* dm, int root_idx) {
+    game_work_list_t list = {};
 
-    if (get_title_id_from_dir(game_path, title_id, sizeof(title_id))) {
-        log_msg("\n=== [SKIP] Could not read Title ID from %s ===\n", game_path);
-        return -1;
+    log_msg("\n[DEVICE] %s connected\n", GAME_PATHS[root_idx]);
+    double t = monotonic_ms();
+    if (discover_root(&list, root_idx) < 0) {
+        work_list_free(&list);
+        return;
     }
+    timing_span(PH_DISCOVERY, root_idx, t);
 
-    // Try to get game name
-    snprintf(param_json_path, sizeof(param_json_path),
-             "%s/sce_sys/param.json", game_path);
-    
-    if (get_game_name_from_json(param_json_path, game_name, sizeof(game_name)) != 0) {
-        // If name extraction fails, use Title ID
-        snprintf(game_name, sizeof(game_name), "%s", title_id);
-    }
-    
-    // Get region
-    const char* region = get_game_region(title_id);
-    
-    // Add region to game name for display
-    char game_name_with_region[300];
-    snprintf(game_name_with_region, sizeof(game_name_with_region), "%s [%s]", game_name, region);
+    dm->root_present[root_idx] = 1;
+    dm->root_dev[root_idx] = list.root_dev[root_idx];
+    dm->root_watch[root_idx] = watcher_add(&dm->watcher, GAME_PATHS[root_idx], WATCH_ROOT, root_idx);
 
-    log_msg("\n=== [%d/%d] %s (%s) ===\n", current, total, game_name_with_region, title_id);
-    
-    // Send progress notification
-    int progress = (total > 0) ? (current * 100) / total : 0;
-    notify("Mounting games... %d/%d (%d%%)\n%s", current, total, progress, game_name_with_region);
-    
-    // Copy game name with region to output if provided
-    if (game_name_out && name_size > 0) {
-        snprintf(game_name_out, name_size, "%s [%s]", game_name, region);
-    }
-    
-    // Check if already mounted
-    if (is_game_already_mounted(title_id, game_path)) {
-        log_msg("  [SKIP] Already mounted\n");
-        return 2;  // Return 2 to indicate skipped
+    device_queue_t stats[NUM_GAME_PATHS];
+    int num_queues = list.count > 0 ? run_worker_pool(&list, g_num_workers, stats) : 0;
+
+    int mounted = 0, skipped = 0, failed = 0;
+    for (int i = 0; i < list.count; i++) {
+        const game_work_t* w = &list.items[i];
+        if (w->result == 0) mounted++;
+        else if (w->result == 2) skipped++;
+        else failed++;
+
+        if (daemon_find_game(dm, w->path) < 0)
+            daemon_add_game(dm, w->path, root_idx);
     }
 
-    if (fix_application_drm_type(param_json_path) > 0)
-        log_msg("  [OK] DRM patched\n");
+    log_msg("[DEVICE] %s - Mounted: %d | Skipped: %d | Failed: %d\n",
+            GAME_PATHS[root_idx], mounted, skipped, failed);
+    log_device_stats(stats, num_queues);
+    notify("%s connected\nMounted %d new game(s)", LOCATION_NAMES[root_idx], mounted);
+    work_list_free(&list);
+}
 
-    snprintf(system_ex_app, sizeof(system_ex_app),
-             "/system_ex/app/%s", title_id);
+// Returns 1 if the root was attached, detached or swapped for another device
+static int daemon_check_device(daemon_t* dm, int root_idx) {
+    uint64_t dev = 0;
+    int present = root_device(root_idx, &dev);
 
-    mkdir(system_ex_app, 0755);
+    if (dm->root_present[root_idx] && present && dev == dm->root_dev[root_idx])
+        return 0;
+    if (!dm->root_present[root_idx] && !present)
+        return 0;
 
-    if (is_mounted(system_ex_app)) {
-        log_msg("  [INFO] Already mounted, unmounting...\n");
-        unmount(system_ex_app, 0);
-    }
+    // Mounts may have come and gone with the device
+    mount_table_load();
+
+    if (dm->root_present[root_idx])
+        daemon_detach(dm, root_idx);
+    if (present)
+        daemon_attach(dm, root_idx);
+    return 1;
+}
 
-    if (mount_nullfs(game_path, system_ex_app)) {
-        log_msg("  [ERROR] Failed to mount: %s (errno: %d)\n", strerror(errno), errno);
+static int daemon_run(void) {
+    daemon_t dm = {};
+
+    if (watcher_open(&dm.watcher) != 0) {
+        log_at(LOG_ERROR, "Daemon mode unavailable (errno: %d)\n", errno);
         return -1;
     }
-    log_msg("  [OK] Mounted to %s\n", system_ex_app);
 
-    snprintf(user_app_dir, sizeof(user_app_dir),
-             "/user/app/%s", title_id);
-    char user_sce_sys[PATH_MAX];
-    snprintf(user_sce_sys, sizeof(user_sce_sys),
-             "%s/sce_sys", user_app_dir);
+    signal(SIGINT, daemon_signal);
+    signal(SIGTERM, daemon_signal);
+
+    // The scan's spans are already reported; this run covers the daemon alone
+    timing_reset();
+    double started = monotonic_ms();
+
+    int roots = 0;
+    for (int i = 0; i < (int)NUM_GAME_PATHS; i++) {
+        dm.root_watch[i] = -1;
+        if (!root_device(i, &dm.root_dev[i]))
+            continue;
+        dm.root_watch[i] = watcher_add(&dm.watcher, GAME_PATHS[i], WATCH_ROOT, i);
+        if (dm.root_watch[i] < 0)
+            continue;
+        dm.root_present[i] = 1;
+        roots++;
+        daemon_rescan_root(&dm, i, 1);
+    }
+
+    // Folders found by the initial scan are already handled
+    for (int i = 0; i < dm.count; i++)
+        if (dm.games[i].path)
+            dm.games[i].pending = 0;
 
-    mkdir(user_app_dir, 0755);
-    mkdir(user_sce_sys, 0755);
+    log_msg("\n[DAEMON] Watching %d location(s), %d game folder(s)\n", roots, dm.count);
 
-    snprintf(src_sce_sys, sizeof(src_sce_sys),
-             "%s/sce_sys", game_path);
+    int slots[256];
+    double next_poll = monotonic_ms() + DEVICE_POLL_MS;
+    while (!g_daemon_stop) {
+        int n = watcher_wait(&dm.watcher, DAEMON_TICK_MS, slots, 256);
+        int changed = 0;
 
-    // Copy with optimized sendfile/large buffer
-    copy_dir(src_sce_sys, user_sce_sys);
-    copy_sce_sys_to_appmeta(src_sce_sys, title_id);
+        for (int i = 0; i < n; i++) {
+            // An attach or detach earlier in this batch may have moved slots
+            if (dm.watcher.items[slots[i]].id < 0) continue;
+            int kind = dm.watcher.items[slots[i]].kind;
+            int target = dm.watcher.items[slots[i]].target;
 
-    if (sceAppInstUtilAppInstallTitleDir(title_id, "/user/app/", 0)) {
-        log_msg("  [ERROR] Registration failed for %s\n", title_id);
-        return -1;
-    }
+            if (kind == WATCH_ROOT) {
+                if (daemon_check_device(&dm, target))
+                    changed = 1;
+                else
+                    daemon_rescan_root(&dm, target, 0);
+            } else if (dm.games[target].path) {
+                if (kind == WATCH_GAME)
+                    daemon_watch_sce_sys(&dm, target);
+                daemon_mark(&dm, target);
+            }
+        }
+
+        // Changes in the lost events are unknown: rescan every root and
+        // let each game's signature decide whether it needs another pass
+        if (dm.watcher.overflowed) {
+            log_at(LOG_WARN, "[DAEMON] Event queue overflowed, rescanning\n");
+            for (int i = 0; i < (int)NUM_GAME_PATHS; i++)
+                if (dm.root_present[i])
+                    daemon_rescan_root(&dm, i, 0);
+            for (int i = 0; i < dm.count; i++)
+                if (dm.games[i].path)
+                    daemon_mark(&dm, i);
+        }
 
-    snprintf(mount_lnk_path, sizeof(mount_lnk_path), 
-             "/user/app/%s/mount.lnk", title_id);
+        double now = monotonic_ms();
+        if (now >= next_poll) {
+            for (int i = 0; i < (int)NUM_GAME_PATHS; i++)
+                if (daemon_check_device(&dm, i))
+                    changed = 1;
+            next_poll = now + DEVICE_POLL_MS;
+        }
 
-    FILE* f = fopen(mount_lnk_path, "w");
-    if (f) {
-        fprintf(f, "%s", game_path);
-        fclose(f);
+        for (int i = 0; i < dm.count; i++) {
+            if (dm.games[i].path && dm.games[i].pending && now >= dm.games[i].due_ms) {
+                daemon_process_game(&dm, i);
+                changed = 1;
+            }
+        }
+
+        // Keep the cache current so a relaunch starts from this state
+        if (changed) {
+            double t = monotonic_ms();
+            registry_save();
+            timing_span(PH_CACHE_SAVE, -1, t);
+            unload_cache();
+            load_cache();
+        }
     }
 
-    update_snd0info(title_id);
+    log_msg("[DAEMON] Stopping\n");
+    deleter_drain();
+    if (timing_write_report("daemon", monotonic_ms() - started) != 0)
+        log_at(LOG_WARN, "Could not write %s (errno: %d)\n", TIMING_FILE, errno);
+    for (int i = 0; i < dm.count; i++)
+        free(dm.games[i].path);
+    free(dm.games);
+    free(dm.index);
+    watcher_close(&dm.watcher);
+    return 0;
+}
 
-    log_msg("  [SUCCESS] %s installed!\n", title_id);
-    
-    // Add to cache
-    if (g_found_count < 256) {
-        strncpy(g_found_games[g_found_count].title_id, title_id, sizeof(g_found_games[0].title_id) - 1);
-        strncpy(g_found_games[g_found_count].name, game_name, sizeof(g_found_games[0].name) - 1);
-        strncpy(g_found_games[g_found_count].path, game_path, sizeof(g_found_games[0].path) - 1);
-        g_found_games[g_found_count].last_seen = time(NULL);
-        g_found_count++;
+// ---------------- BENCHMARKS ----------------
+// game_mounter --bench-json <param.json> [iterations] compares the tokenizer
+// with the strstr() lookup the payload used before it.
+static int strstr_extract_json_string(const char* json, const char* key,
+                                      char* out, size_t out_size) {
+    char search[64];
+    snprintf(search, sizeof(search), "\"%s\"", key);
+
+    const char* p = strstr(json, search);
+    if (!p) return -1;
+
+    p = strchr(p + strlen(search), ':');
+    if (!p) return -1;
+
+    while (*++p && isspace(*p));
+    if (*p != '"') return -1;
+    p++;
+
+    size_t i = 0;
+    while (i < out_size - 1 && p[i] && p[i] != '"') {
+        out[i] = p[i];
+        i++;
     }
-    
+    out[i] = '\0';
     return 0;
 }
 
-// ---------------- AUTO UNMOUNT DELETED GAMES ----------------
-static int auto_unmount_deleted_games(void) {
-    // Scan /system_ex/app/ to find ALL games (mounted and native)
-    DIR* d = opendir("/system_ex/app");
-    if (!d) return 0;
+static int bench_json(const char* path, int iterations) {
+    size_t len;
+    char* json = read_small_file(NULL, path, 1024 * 1024, &len);
+    if (!json) {
+        printf("Cannot read %s\n", path);
+        return 1;
+    }
+    if (iterations < 1) iterations = 100000;
 
-    int unmounted = 0;
-    struct dirent* e;
+    static const char* const keys[][2] = {
+        { "titleId",            "titleId" },
+        { "contentName",        "contentName" },
+        { "applicationDrmType", "applicationDrmType" },
+        { "titleName",          "localizedParameters.en-US.titleName" },
+    };
+    const int num_keys = sizeof(keys) / sizeof(keys[0]);
+    char out[256];
+    volatile size_t sink = 0;
 
-    while ((e = readdir(d))) {
-        if (!strcmp(e->d_name, ".") || !strcmp(e->d_name, ".."))
-            continue;
+    printf("%s: %zu bytes, %d iterations, %s scan\n", path, len, iterations,
+#if defined(__SSE2__)
+           "SSE2"
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+           "NEON"
+#else
+           "scalar"
+#endif
+           );
 
-        // Check if this looks like a title ID (CUSA/PPSA format)
-        if ((strncmp(e->d_name, "CUSA", 4) != 0 && 
-             strncmp(e->d_name, "PPSA", 4) != 0) || 
-            strlen(e->d_name) != 9) {
-            continue;
+    for (int k = 0; k < num_keys; k++) {
+        double t0 = monotonic_ms();
+        for (int i = 0; i < iterations; i++) {
+            out[0] = '\0';
+            strstr_extract_json_string(json, keys[k][0], out, sizeof(out));
+            sink += out[0];
         }
+        double t1 = monotonic_ms();
+        char legacy[256] = {};
+        strstr_extract_json_string(json, keys[k][0], legacy, sizeof(legacy));
 
-        char mount_lnk[PATH_MAX];
-        snprintf(mount_lnk, sizeof(mount_lnk), "/user/app/%s/mount.lnk", e->d_name);
-        char game_path[PATH_MAX] = {};
-        int should_unmount = 0;
+        double t2 = monotonic_ms();
+        for (int i = 0; i < iterations; i++) {
+            out[0] = '\0';
+            json_get_string(json, len, keys[k][1], out, sizeof(out));
+            sink += out[0];
+        }
+        double t3 = monotonic_ms();
+        char parsed[256] = {};
+        json_get_string(json, len, keys[k][1], parsed, sizeof(parsed));
 
-        // Check if this was a mounted game by looking for sce_sys folder
-        char sce_sys_path[PATH_MAX];
-        snprintf(sce_sys_path, sizeof(sce_sys_path), "/user/app/%s/sce_sys", e->d_name);
-        struct stat sce_sys_stat;
-        int has_sce_sys = (stat(sce_sys_path, &sce_sys_stat) == 0 && S_ISDIR(sce_sys_stat.st_mode));
-        
-        FILE* f = fopen(mount_lnk, "r");
-        if (!f) {
-            if (has_sce_sys) {
-                // This was a mounted game - check if source folder still exists
-                int found_source = 0;
-                for (int i = 0; i < (int)NUM_GAME_PATHS; i++) {
-                    char check_path[PATH_MAX];
-                    snprintf(check_path, sizeof(check_path), "%s/%s-app", GAME_PATHS[i], e->d_name);
-                    struct stat st;
-                    if (stat(check_path, &st) == 0 && S_ISDIR(st.st_mode)) {
-                        found_source = 1;
-                        break;
-                    }
-                }
-                
-                if (!found_source) {
-                    should_unmount = 1;
-                } else {
-                    continue;
-                }
-            }
-            
-            // Also check if it's a nullfs mount without mount.lnk
-            if (!should_unmount) {
-                char system_ex_path[PATH_MAX];
-                snprintf(system_ex_path, sizeof(system_ex_path), "/system_ex/app/%s", e->d_name);
-                
-                if (is_mounted(system_ex_path)) {
-                    int found_source = 0;
-                    for (int i = 0; i < (int)NUM_GAME_PATHS; i++) {
-                        char check_path[PATH_MAX];
-                        snprintf(check_path, sizeof(check_path), "%s/%s-app", GAME_PATHS[i], e->d_name);
-                        struct stat st;
-                        if (stat(check_path, &st) == 0 && S_ISDIR(st.st_mode)) {
-                            found_source = 1;
-                            break;
-                        }
-                    }
-                    
-                    if (!found_source) {
-                        should_unmount = 1;
-                    }
-                }
-            }
-            
-            if (!should_unmount) {
-                continue;
-            }
-        } else if (fgets(game_path, sizeof(game_path), f)) {
-            game_path[strcspn(game_path, "\r\n")] = '\0';
-            fclose(f);
+        printf("  %-36s strstr %8.1f ns  tokenizer %8.1f ns  %s\n", keys[k][1],
+               (t1 - t0) * 1e6 / iterations, (t3 - t2) * 1e6 / iterations,
+               strcmp(legacy, parsed) ? "(results differ)" : "");
+    }
 
-            // Check if the game path still exists
-            struct stat st;
-            if (stat(game_path, &st) != 0 || !S_ISDIR(st.st_mode)) {
-                should_unmount = 1;
-            }
-        } else {
-            fclose(f);
-        }
-        
-        if (should_unmount) {
-            char system_ex_app[PATH_MAX];
-            snprintf(system_ex_app, sizeof(system_ex_app), 
-                     "/system_ex/app/%s", e->d_name);
-            
-            log_msg("  [CLEANUP] Unmounting deleted game: %s\n", e->d_name);
-            
-            // Try to unmount
-            if (is_mounted(system_ex_app)) {
-                if (unmount(system_ex_app, 0) != 0) {
-                    log_msg("  [WARN] Normal unmount failed for %s, forcing...\n", e->d_name);
-                    if (unmount(system_ex_app, MNT_FORCE) != 0) {
-                        log_msg("  [ERROR] Force unmount failed for %s (errno: %d)\n", e->d_name, errno);
-                    }
-                }
-            }
-            
-            // Wait a moment for unmount to complete
-            usleep(100000); // 100ms
-            
-            // Clean up directories
-            char user_app_dir[PATH_MAX];
-            snprintf(user_app_dir, sizeof(user_app_dir), "/user/app/%s", e->d_name);
-            rmdir_recursive(user_app_dir);
-            
-            char appmeta_dir[PATH_MAX];
-            snprintf(appmeta_dir, sizeof(appmeta_dir), "/user/appmeta/%s", e->d_name);
-            rmdir_recursive(appmeta_dir);
-            
-            log_msg("  [OK] Cleaned up %s\n", e->d_name);
-            unmounted++;
+    // What process_game() needs per game: five lookups vs. one walk
+    static const char* const meta_keys[] = {
+        "titleId", "contentName", "contentVersion", "applicationDrmType", "titleName",
+    };
+    double t0 = monotonic_ms();
+    for (int i = 0; i < iterations; i++) {
+        for (int k = 0; k < 5; k++) {
+            out[0] = '\0';
+            strstr_extract_json_string(json, meta_keys[k], out, sizeof(out));
+            sink += out[0];
         }
     }
+    double t1 = monotonic_ms();
+    for (int i = 0; i < iterations; i++) {
+        game_meta_t m;
+        m.title_id[0] = m.content_name[0] = '\0';
+        m.num_names = 0;
+        game_meta_parse_json(json, len, &m);
+        sink += m.title_id[0];
+    }
+    double t2 = monotonic_ms();
+    printf("  %-36s strstr %8.1f ns  tokenizer %8.1f ns\n", "all metadata fields",
+           (t1 - t0) * 1e6 / iterations, (t2 - t1) * 1e6 / iterations);
 
-    closedir(d);
-    
-    return unmounted;
+    free(json);
+    return (int)(sink & 0);
 }
 
 // ---------------- MAIN ----------------
-int main(void) {
+int main(int argc, char** argv) {
+    int daemon_mode = 0;
+    const char* record_file = NULL;
+#ifdef GM_HOST
+    const char* replay_file = NULL;
+#endif
+
+    for (int i = 1; i < argc; i++) {
+        // --workers N: number of games processed concurrently
+        if (!strcmp(argv[i], "--workers") && i + 1 < argc) {
+            int n = atoi(argv[++i]);
+            g_num_workers = (n < 1) ? 1 : (n > MAX_WORKERS) ? MAX_WORKERS : n;
+        }
+        // --sync-hash: compare file contents, not just size and mtime
+        if (!strcmp(argv[i], "--sync-hash"))
+            g_sync_hash = 1;
+        // --usb-workers N: concurrency limit for each USB device queue
+        if (!strcmp(argv[i], "--usb-workers") && i + 1 < argc) {
+            int n = atoi(argv[++i]);
+            g_usb_limit = (n < 1) ? 1 : (n > MAX_WORKERS) ? MAX_WORKERS : n;
+        }
+        // --no-fast-start: wait for the scan instead of restoring cached mounts first
+        if (!strcmp(argv[i], "--no-fast-start"))
+            g_fast_start = 0;
+        // --daemon: stay resident after the scan and follow folder changes
+        if (!strcmp(argv[i], "--daemon"))
+            daemon_mode = 1;
+        // --notify-rate N: at most N progress notifications per second
+        if (!strcmp(argv[i], "--notify-rate") && i + 1 < argc) {
+            int n = atoi(argv[++i]);
+            g_notify.rate = (n < 1) ? 1 : (n > 20) ? 20 : n;
+        }
+        // --record FILE: write a binary trace of every fs/mount/registration call
+        if (!strcmp(argv[i], "--record") && i + 1 < argc)
+            record_file = argv[++i];
+#ifdef GM_HOST
+        // --replay FILE: give each call the duration it had in a recorded trace
+        if (!strcmp(argv[i], "--replay") && i + 1 < argc)
+            replay_file = argv[++i];
+#endif
+        // --log-level debug|info|warn|error: drop less important messages
+        if (!strcmp(argv[i], "--log-level") && i + 1 < argc) {
+            int level = log_parse_level(argv[++i]);
+            if (level >= 0) g_log.level = level;
+        }
+    }
+
+    if (argc > 2 && !strcmp(argv[1], "--bench-json")) {
+        return bench_json(argv[2], (argc > 3) ? atoi(argv[3]) : 0);
+    }
+
+    // game_mounter --dump-cache [out.json]: write the binary cache as JSON and exit
+    if (argc > 1 && !strcmp(argv[1], "--dump-cache")) {
+        const char* out = (argc > 2) ? argv[2] : CACHE_JSON_FILE;
+        if (load_cache() < 0) {
+            printf("Cannot read %s\n", CACHE_FILE);
+            return 1;
+        }
+        int n = dump_cache_json(out);
+        unload_cache();
+        if (n < 0) {
+            printf("Cannot write %s\n", out);
+            return 1;
+        }
+        printf("Dumped %d cache entries to %s\n", n, out);
+        return 0;
+    }
+
     log_init();
+    notify_init();
+
+    if (record_file) {
+        if (trace_record_open(record_file) == 0) {
+            trace_start();
+            log_msg("[INFO] Recording trace to %s\n", record_file);
+        } else {
+            log_at(LOG_WARN, "Cannot record to %s (errno: %d)\n", record_file, errno);
+        }
+    }
+#ifdef GM_HOST
+    if (replay_file) {
+        int n = trace_replay_open(replay_file);
+        if (n >= 0) {
+            trace_start();
+            log_msg("[INFO] Replaying %d recorded call(s) from %s\n", n, replay_file);
+        } else {
+            log_at(LOG_WARN, "Cannot replay %s (errno: %d)\n", replay_file, errno);
+        }
+    }
+#endif
     
-    time_t start_time = time(NULL);
+    double start_ms = monotonic_ms();
     
     notify("Game Mounter\nBy Manos\nStarting...");
     log_msg("===========================================\n");
@@ -978,20 +5115,23 @@ int main(void) {
     log_msg("  Scanning multiple locations for games\n");
     log_msg("===========================================\n");
 
+    double t = monotonic_ms();
     remount_system_ex();
+    timing_span(PH_REMOUNT, -1, t);
     log_msg("[OK] Remounted /system_ex\n");
+    dirs_open();
+
+    int num_mounts = mount_table_load();
+    log_msg("[INFO] Mount table: %d entries\n", num_mounts);
 
     sceAppInstUtilInitialize();
     
     // Load cache
-    game_cache_entry_t* cache_entries = NULL;
-    int cache_count = 0;
-    load_cache(&cache_entries, &cache_count);
-    log_msg("[INFO] Loaded %d cached entries\n", cache_count);
+    t = monotonic_ms();
+    int cache_count = load_cache();
+    timing_span(PH_CACHE_LOAD, -1, t);
+    log_msg("[INFO] Loaded %d cached entries\n", cache_count > 0 ? cache_count : 0);
     
-    // Auto-unmount deleted games first
-    int cleaned = auto_unmount_deleted_games();
-
     log_msg("\n=== Scanning for games ===\n");
 
     int total_mounted = 0;
@@ -999,115 +5139,109 @@ int main(void) {
     int total_failed = 0;
     int total_games = 0;
     
-    // Store mounted game names for notification
-    char mounted_games[10][256];  // Store up to 10 game names
-    int stored_names = 0;
-    
-    // First pass: count total games for progress
-    for (int path_idx = 0; path_idx < (int)NUM_GAME_PATHS; path_idx++) {
-        const char* base_path = GAME_PATHS[path_idx];
-        struct stat st;
-        
-        if (stat(base_path, &st) != 0 || !S_ISDIR(st.st_mode))
-            continue;
-        
-        DIR* d = opendir(base_path);
-        if (!d) continue;
-        
-        struct dirent* e;
-        while ((e = readdir(d))) {
-            if (!strcmp(e->d_name, ".") || !strcmp(e->d_name, ".."))
-                continue;
-            
-            char game_path[PATH_MAX];
-            snprintf(game_path, sizeof(game_path), "%s/%s", base_path, e->d_name);
-            
-            if (stat(game_path, &st) == 0 && S_ISDIR(st.st_mode))
-                total_games++;
+    // Single discovery pass: the work list drives both progress and processing.
+    // It runs in the background while known titles are restored from the cache.
+    game_work_list_t work = {};
+    pthread_t discovery;
+    int discovery_async = g_fast_start && cache_count > 0 &&
+                          pthread_create(&discovery, NULL, discovery_main, &work) == 0;
+
+    int restored = 0;
+    if (discovery_async) {
+        t = monotonic_ms();
+        restored = fast_start_restore();
+        timing_span(PH_FAST_START, -1, t);
+        if (restored > 0) {
+            log_msg("[INFO] Restored %d game(s) from cache in %.0f ms\n", restored, monotonic_ms() - t);
+            notify("Restored %d game(s)\nChecking for changes...", restored);
         }
-        closedir(d);
+        pthread_join(discovery, NULL);
+    } else {
+        discovery_main(&work);
     }
+    total_games = work.count;
     
     log_msg("[INFO] Found %d potential games to process\n", total_games);
-    int current_game = 0;
+
+    // Unmount games whose source folder is gone, judged against what
+    // discovery just found
+    int cleaned = 0;
+    path_set_t present = {};
+    deleter_start();
+    t = monotonic_ms();
+    if (path_set_build(&present, &work) == 0) {
+        cleaned = auto_unmount_deleted_games(&present);
+    } else {
+        log_at(LOG_WARN, "  Out of memory, skipping cleanup of deleted games\n");
+    }
+    path_set_free(&present);
+    timing_span(PH_CLEANUP, -1, t);
     
-    // Scan all configured paths
-    for (int path_idx = 0; path_idx < (int)NUM_GAME_PATHS; path_idx++) {
-        const char* base_path = GAME_PATHS[path_idx];
-        struct stat st;
-        
-        // Check if path exists
-        if (stat(base_path, &st) != 0 || !S_ISDIR(st.st_mode)) {
-            log_msg("  [%d/%d] Skipping %s (not found)\n", path_idx + 1, (int)NUM_GAME_PATHS, base_path);
-            continue;
+    int mounted_count[NUM_GAME_PATHS] = {};
+    int skipped_count[NUM_GAME_PATHS] = {};
+    int failed_count[NUM_GAME_PATHS] = {};
+    
+    log_msg("[INFO] Processing with %d worker(s)\n", g_num_workers);
+    device_queue_t device_stats[NUM_GAME_PATHS];
+    int num_devices = run_worker_pool(&work, g_num_workers, device_stats);
+    
+    for (int i = 0; i < work.count; i++) {
+        const game_work_t* w = &work.items[i];
+        if (w->result == 0) {
+            mounted_count[w->root_idx]++;
+        } else if (w->result == 2) {
+            skipped_count[w->root_idx]++;
+        } else {
+            failed_count[w->root_idx]++;
         }
-        
-        log_msg("  [%d/%d] Scanning: %s\n", path_idx + 1, (int)NUM_GAME_PATHS, base_path);
-        
-        DIR* d = opendir(base_path);
-        if (!d) {
-            log_msg("  Warning: Cannot open %s (errno: %d)\n", base_path, errno);
+    }
+    
+    for (int path_idx = 0; path_idx < (int)NUM_GAME_PATHS; path_idx++) {
+        if (!work.root_available[path_idx])
             continue;
-        }
-        
-        int mounted_count = 0;
-        int skipped_count = 0;
-        int failed_count = 0;
-        
-        struct dirent* e;
-        while ((e = readdir(d))) {
-            char game_path[PATH_MAX];
-            
-            if (!strcmp(e->d_name, ".") || !strcmp(e->d_name, ".."))
-                continue;
-
-            snprintf(game_path, sizeof(game_path), "%s/%s", base_path, e->d_name);
-
-            if (stat(game_path, &st) != 0 || !S_ISDIR(st.st_mode))
-                continue;
-
-            current_game++;
-            char game_name[256] = {};
-            int result = process_game(game_path, game_name, sizeof(game_name), current_game, total_games);
-            if (result == 0) {
-                // Successfully mounted
-                if (stored_names < 10) {
-                    snprintf(mounted_games[stored_names], sizeof(mounted_games[0]), "%s", game_name);
-                    stored_names++;
-                }
-                mounted_count++;
-            } else if (result == 2) {
-                skipped_count++;
-            } else {
-                failed_count++;
-            }
-        }
-
-        closedir(d);
         
-        log_msg("    Mounted: %d | Skipped: %d | Failed: %d\n", 
-               mounted_count, skipped_count, failed_count);
+        log_msg("  %s - Mounted: %d | Skipped: %d | Failed: %d\n", GAME_PATHS[path_idx],
+               mounted_count[path_idx], skipped_count[path_idx], failed_count[path_idx]);
         
-        total_mounted += mounted_count;
-        total_skipped += skipped_count;
-        total_failed += failed_count;
+        total_mounted += mounted_count[path_idx];
+        total_skipped += skipped_count[path_idx];
+        total_failed += failed_count[path_idx];
     }
 
+    // Deletions ran alongside the mounts; wait for the rest before reporting
+    delete_stats_t freed = deleter_drain();
+
     log_msg("\n===========================================\n");
     log_msg("  SUMMARY\n");
     if (cleaned > 0) {
         log_msg("  Cleaned up: %d deleted game(s)\n", cleaned);
     }
+    if (freed.inodes > 0) {
+        log_msg("  Freed: %.1f MB in %lld file(s)/folder(s)\n",
+                freed.bytes / (1024.0 * 1024.0), freed.inodes);
+    }
+    if (restored > 0) {
+        log_msg("  Restored from cache: %d games\n", restored);
+    }
     log_msg("  New mounts: %d games\n", total_mounted);
-    if (total_mounted > 0 && stored_names > 0) {
+    if (total_mounted > 0) {
         log_msg("  Mounted games:\n");
-        for (int i = 0; i < stored_names; i++) {
-            log_msg("    - %s\n", mounted_games[i]);
+        for (int i = 0; i < work.count; i++) {
+            if (work.items[i].result == 0)
+                log_msg("    - %s\n", work.items[i].name ? work.items[i].name : work.items[i].path);
         }
     }
     log_msg("  Already mounted: %d games\n", total_skipped);
     log_msg("  Failed: %d games\n", total_failed);
+    for (int i = 0; i < work.count; i++) {
+        if (work.items[i].result != 0 && work.items[i].result != 2)
+            log_msg("    - %s\n", work.items[i].path);
+    }
     log_msg("  Total active: %d games\n", total_mounted + total_skipped);
+    if (num_devices > 0) {
+        log_msg("  Devices:\n");
+        log_device_stats(device_stats, num_devices);
+    }
     log_msg("===========================================\n");
     
     // Build detailed notification with scan results
@@ -1124,51 +5258,63 @@ int main(void) {
     }
     
     // Add location scan results to notification with descriptive names
-    const char* location_names[] = {
-        "Internal",
-        "USB0",
-        "USB1",
-        "USB2",
-        "USB3",
-        "M.2 SSD"
-    };
-    
     for (int i = 0; i < (int)NUM_GAME_PATHS; i++) {
-        struct stat st;
         char line[128];
-        if (stat(GAME_PATHS[i], &st) == 0 && S_ISDIR(st.st_mode)) {
-            snprintf(line, sizeof(line), "\n✅ %s", location_names[i]);
+        if (work.root_available[i]) {
+            snprintf(line, sizeof(line), "\n✅ %s", LOCATION_NAMES[i]);
         } else {
-            snprintf(line, sizeof(line), "\n❌ %s", location_names[i]);
+            snprintf(line, sizeof(line), "\n❌ %s", LOCATION_NAMES[i]);
         }
         strcat(notification_msg, line);
     }
     
     notify("%s", notification_msg);
 
+    // Name the new titles, as many as fit on screen
     if (total_mounted > 0) {
-        if (stored_names > 0 && stored_names == total_mounted) {
-            char msg[2048] = "Mounted:\n";
-            for (int i = 0; i < stored_names; i++) {
-                strcat(msg, mounted_games[i]);
-                if (i < stored_names - 1) strcat(msg, "\n");
-            }
-            notify("%s", msg);
+        char msg[NOTIFY_MSG_SIZE] = "Mounted:";
+        size_t len = strlen(msg);
+        int listed = 0;
+        for (int i = 0; i < work.count && listed < NOTIFY_MAX_NAMES && len < sizeof(msg); i++) {
+            if (work.items[i].result != 0 || !work.items[i].name) continue;
+            len += snprintf(msg + len, sizeof(msg) - len, "\n%s", work.items[i].name);
+            listed++;
         }
+        if (total_mounted > listed && len < sizeof(msg))
+            snprintf(msg + len, sizeof(msg) - len, "\n+%d more", total_mounted - listed);
+        notify("%s", msg);
     }
     
-    // Save cache for next run
-    if (g_found_count > 0) {
-        save_cache(g_found_games, g_found_count);
-        log_msg("[INFO] Saved %d games to cache\n", g_found_count);
-    }
-    if (cache_entries) {
-        free(cache_entries);
-    }
+    // Save cache for next run, even if empty: titles cleaned up this run must
+    // not stay marked mounted for the next fast start
+    t = monotonic_ms();
+    int saved = registry_save();
+    timing_span(PH_CACHE_SAVE, -1, t);
+    if (saved >= 0)
+        log_msg("[INFO] Saved %d games to cache\n", saved);
+    else
+        log_at(LOG_WARN, "Could not write %s (errno: %d)\n", CACHE_FILE, errno);
+    log_at(LOG_DEBUG, "Registry: %d game(s), %u string(s), %zu KB\n", g_registry.count,
+           g_registry.string_count,
+           (g_registry.capacity * sizeof(game_cache_entry_t) + g_registry.arena_bytes +
+            g_registry.index_slots * sizeof(uint32_t) + g_registry.string_slots * sizeof(char*)) / 1024);
+    work_list_free(&work);
     
-    time_t end_time = time(NULL);
-    int elapsed = (int)(end_time - start_time);
-    log_msg("\n[INFO] Game Mounter completed in %d seconds\n", elapsed);
+    double elapsed_ms = monotonic_ms() - start_ms;
+    log_msg("\n[INFO] Phase timings:\n");
+    timing_log_summary();
+    if (timing_write_report("scan", elapsed_ms) != 0)
+        log_at(LOG_WARN, "Could not write %s (errno: %d)\n", TIMING_FILE, errno);
+    log_msg("\n[INFO] Game Mounter completed in %.2f seconds\n", elapsed_ms / 1000.0);
+
+    if (daemon_mode)
+        daemon_run();
+
+    notify_close();
+    trace_close();
+    unload_cache();
+    registry_free();
+    dirs_close();
     log_close();
 
     return 0;